@@ -458,6 +458,7 @@ namespace API_3DTI
                 // HRTF interpolation
                 Common3DTIGUI.BeginSubsection("HRTF Interpolation");
                 CreateControl(Parameter.HRTFResamplingStep);
+                CreateControl(Parameter.HRIRStorageFormat);
                 Common3DTIGUI.EndSubsection();
 
 
@@ -480,6 +481,23 @@ namespace API_3DTI
                 CreateControl(Parameter.ReverbOrder);
                 Common3DTIGUI.EndSubsection();
 
+                Common3DTIGUI.BeginSubsection("Sources");
+                CreateControl(Parameter.SourcePoolSize);
+                CreateControl(Parameter.PoseAngleTolerance);
+                CreateControl(Parameter.PoseDistanceTolerance);
+                CreateControl(Parameter.HeadPoseOutputLatency);
+                Common3DTIGUI.EndSubsection();
+
+                Common3DTIGUI.BeginSubsection("Adaptive quality");
+                CreateControl(Parameter.EnableAdaptiveQuality);
+                CreateControl(Parameter.AdaptiveQualityMaxLevel);
+                CreateControl(Parameter.AdaptiveQualityDegradeLoad);
+                CreateControl(Parameter.AdaptiveQualityRestoreLoad);
+                CreateControl(Parameter.AdaptiveQualityRestoreTime);
+                CreateControl(Parameter.AdaptiveQualityReverbDistance, 0.0f, 100.0f);
+                CreateControl(Parameter.AdaptiveQualityEconomyShare);
+                Common3DTIGUI.EndSubsection();
+
                 //// Debug Log
                 //Common3DTIGUI.BeginSubsection("Debug log");
                 //Common3DTIGUI.AddLabelToParameterGroup("Write debug log file");
@@ -0,0 +1,71 @@
+﻿using UnityEngine;
+using UnityEngine.Audio;
+
+namespace API_3DTI
+{
+    /// <summary>
+    /// Attach to any GameObject to hear the scene from its pose as well as from the AudioListener. Route the output with a
+    /// "BRT Listener Output" mixer effect whose Listener parameter is set to <see cref="listenerOutputValue"/>. Expose that
+    /// parameter and name it in <see cref="listenerParameter"/> to have it set while this component is enabled.
+    /// </summary>
+    public class AdditionalListener : MonoBehaviour
+    {
+        public Spatializer spatializer;
+
+        // Optional exposed Listener parameter of the "BRT Listener Output" effect playing this listener
+        public AudioMixer outputMixer;
+        public string listenerParameter;
+
+        // Handle assigned by the plugin while enabled
+        public uint listenerHandle { get; private set; } = Spatializer.InvalidHandle;
+
+        // Value for the Listener parameter of the "BRT Listener Output" effect. It changes every time the listener is added.
+        public float listenerOutputValue => Spatializer.GetListenerOutputValue(listenerHandle);
+
+        void OnEnable()
+        {
+            if (spatializer == null)
+            {
+                spatializer = FindObjectOfType<Spatializer>();
+            }
+            if (spatializer == null)
+            {
+                Debug.LogError("AdditionalListener needs a Spatializer in the scene.", this);
+                return;
+            }
+
+            listenerHandle = spatializer.AddListener();
+            if (listenerHandle == Spatializer.InvalidHandle)
+            {
+                Debug.LogError("Failed to add listener to the Spatializer.", this);
+            }
+            SetOutputParameter();
+        }
+
+        void Update()
+        {
+            if (listenerHandle != Spatializer.InvalidHandle)
+            {
+                spatializer.SetListenerTransform(listenerHandle, transform);
+            }
+        }
+
+        void OnDisable()
+        {
+            if (listenerHandle != Spatializer.InvalidHandle)
+            {
+                spatializer.RemoveListener(listenerHandle);
+                listenerHandle = Spatializer.InvalidHandle;
+                SetOutputParameter();
+            }
+        }
+
+        void SetOutputParameter()
+        {
+            if (outputMixer != null && !string.IsNullOrEmpty(listenerParameter) && !outputMixer.SetFloat(listenerParameter, listenerOutputValue))
+            {
+                Debug.LogError($"Exposed parameter {listenerParameter} not found on {outputMixer.name}.", this);
+            }
+        }
+    }
+}
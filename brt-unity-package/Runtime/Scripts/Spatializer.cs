@@ -42,6 +42,18 @@ namespace API_3DTI
         ReverbBRIR,
     }
 
+    public enum BinaryLoadStatus : int
+    {
+        // These values must match the C++ values
+        InvalidHandle = -1,
+        Queued = 0,
+        InProgress = 1,
+        Ready = 2,
+        Completed = 3,
+        Failed = 4,
+        Superseded = 5,
+    }
+
     public enum SpatializationMode : int
     {
         SPATIALIZATION_MODE_NONE = 0,
@@ -49,6 +61,14 @@ namespace API_3DTI
         SPATIALIZATION_MODE_HIGH_QUALITY = 2,
     }
 
+    public enum HRIRStorageFormat : int
+    {
+        // These values must match the C++ values
+        Float32 = 0,
+        Float16 = 1,
+        BFloat16 = 2,
+    }
+
     public enum ReverbOrder : int
     {
         Adimensional,
@@ -56,6 +76,15 @@ namespace API_3DTI
         ThreeDimensional,
     }
 
+    public enum QualityLevel : int
+    {
+        // These values must match the C++ values. Each level keeps the reductions of the levels above it.
+        Full = 0,
+        NoDistantReverb = 1,    // Sources further than the reverb distance are taken off the reverb
+        NoInterpolation = 2,    // HRTF interpolation and the near field filters are turned off
+        Economy = 3,            // The furthest sources are only repositioned every few audio blocks. Their rendering costs the same, so this frees little time.
+    }
+
     public class Spatializer : MonoBehaviour
     {
 
@@ -63,6 +92,15 @@ namespace API_3DTI
         public AudioMixer spatializereCoreMixer;
         private bool isInitialized = false;
 
+        // If true, binary resources are read on background threads in the plugin so scene start does not block on SOFA parsing.
+        // Sources play without spatialisation for a role until its resource has finished loading.
+        // Resources for additional listeners are always loaded in the background.
+        public bool loadBinaryResourcesAsynchronously = true;
+
+        // Plugin job handles for binary resources that are still loading
+        private Dictionary<BinaryResourceRole, int> binaryLoadJobs = new Dictionary<BinaryResourceRole, int>();
+        private Dictionary<(uint listener, BinaryResourceRole role), int> listenerBinaryLoadJobs = new Dictionary<(uint listener, BinaryResourceRole role), int>();
+
         // Note: The numbering of these parameters must be kept in sync with the C++ plugin source code. Per-source parameters must appear first for compatibility with the plugin.
         // The int value of these enums may change in future versions. For compatibility, always use the enum value name rather than the int value (i.e. use SptaializerParameter.PARAM_HRTF_INTERPOLATION instead of 0).
         public enum Parameter
@@ -88,14 +126,14 @@ namespace API_3DTI
             [SpatializerParameter(label = "Enable reverb distance attenuation", description = "Enable attenuation of sound depending on distance to listener for reverb processing", min = 0.0f, max = 1.0f, type = typeof(bool), defaultValue = 0, isSourceParameter = true)]
             EnableDistanceAttenuationReverb = 6,
 
-            [SpatializerParameter(label = "Head radius", description = "Set listener head radius", units = "m", min = 0.0f, max = 1e20f, defaultValue = 0.0875f)]
+            [SpatializerParameter(label = "Head radius", description = "Set listener head radius. Changing it rebuilds the HRTF table in the background", units = "m", min = 0.0f, max = 1e20f, defaultValue = 0.0875f)]
             HeadRadius = 7,
 
             // TODO: Add remaining default values
             [SpatializerParameter(label = "Scale factor", description = "Set the proportion between metres and Unity scale units", min = 1e-20f, max = 1e20f, defaultValue = 1.0f)]
             ScaleFactor = 8,
 
-            [SpatializerParameter(label = "Enable custom ITD", description = "Enable Interaural Time Difference customization", type = typeof(bool), defaultValue = 0.0f)]
+            [SpatializerParameter(label = "Enable custom ITD", description = "Enable Interaural Time Difference customization. Changing it rebuilds the HRTF table in the background", type = typeof(bool), defaultValue = 0.0f)]
             EnableCustomITD = 9,
 
             [SpatializerParameter(label = "Anechoic distance attenuation", description = "Set attenuation in dB for each double distance", min = -30.0f, max = 0.0f, units = "dB", defaultValue = -6.0206f)]
@@ -137,8 +175,44 @@ namespace API_3DTI
             [SpatializerParameter(label = "Reverb distance attenuation", description = "Set attenuation for reverb calculation in dB for each double distance", min = -30.0f, max = 0.0f, units = "dB", defaultValue = -3.01f)]
             ReverbDistanceAttenuation = 21,
 
+            [SpatializerParameter(label = "HRIR storage format", description = "Precision the raw HRTF measurements are held in while the HRTF table is interpolated from them, at a small cost in accuracy (Float16 is the more accurate of the two). The copy is freed once the table is built, and the HRTF and BRIR tables BRT convolves with stay 32 bit float whatever the format, so this only lowers the peak memory of a load and saves nothing afterwards.", min = 0, max = 2, type = typeof(HRIRStorageFormat), defaultValue = 0.0f)]
+            HRIRStorageFormat = 22,
+
+            [SpatializerParameter(label = "Source pool size", description = "Number of sound sources created ahead of time. Spawning or destroying an AudioSource then takes one from the pool or returns it without changing how the renderer is wired, which is much quicker when many are spawned at once. Idle pooled sources stay connected and play silence, so each still costs some rendering time. The pool grows if more are needed but never shrinks.", min = 0, max = 256, type = typeof(int), defaultValue = 16)]
+            SourcePoolSize = 23,
+
+            [SpatializerParameter(label = "Enable adaptive quality", description = "Reduce rendering quality step by step when the audio thread is close to missing its deadline, and restore it once there is headroom again. Off by default, as it changes the render. Interpolation and near field settings are put back as they were when quality is restored. See GetQualityState for the current level.", type = typeof(bool), defaultValue = 0.0f)]
+            EnableAdaptiveQuality = 24,
+
+            [SpatializerParameter(label = "Lowest adaptive quality level", description = "The furthest adaptive quality may step down. Economy only makes distant sources update their position less often and barely reduces the load, so it is not used by default.", min = 0, max = 3, type = typeof(QualityLevel), defaultValue = (float)QualityLevel.NoInterpolation)]
+            AdaptiveQualityMaxLevel = 25,
+
+            [SpatializerParameter(label = "Adaptive quality degrade load", description = "Share of the audio block duration the average processing time must exceed for quality to step down. Overrunning blocks also step it down.", min = 0.1f, max = 2.0f, defaultValue = 0.8f)]
+            AdaptiveQualityDegradeLoad = 26,
+
+            [SpatializerParameter(label = "Adaptive quality restore load", description = "Share of the audio block duration the average processing time must stay under for quality to step back up. Keep it below the degrade load so the quality doesn't flip between levels.", min = 0.0f, max = 2.0f, defaultValue = 0.5f)]
+            AdaptiveQualityRestoreLoad = 27,
+
+            [SpatializerParameter(label = "Adaptive quality restore time", description = "How long the load must stay under the restore load before each step back up.", units = "s", min = 0.0f, max = 600.0f, defaultValue = 2.0f)]
+            AdaptiveQualityRestoreTime = 28,
+
+            [SpatializerParameter(label = "Adaptive quality reverb distance", description = "Sources further than this from the listener are taken off the reverb from the NoDistantReverb level down.", units = "m", min = 0.0f, max = 1e20f, defaultValue = 10.0f)]
+            AdaptiveQualityReverbDistance = 29,
+
+            [SpatializerParameter(label = "Adaptive quality economy share", description = "Share of the sources, furthest first, that the Economy level applies to.", min = 0.0f, max = 1.0f, defaultValue = 0.5f)]
+            AdaptiveQualityEconomyShare = 30,
+
+            [SpatializerParameter(label = "Pose angle tolerance", description = "How far the direction of a source, as heard by the listener, or the listener's orientation may turn before the renderer is updated. Sources that don't move, or move less than this, cost no repositioning. 0 updates on any change.", units = "deg", min = 0.0f, max = 10.0f, defaultValue = 0.5f)]
+            PoseAngleTolerance = 31,
+
+            [SpatializerParameter(label = "Pose distance tolerance", description = "How far the distance from a source to the listener, or the listener's position, may change before the renderer is updated.", units = "m", min = 0.0f, max = 1.0f, defaultValue = 0.01f)]
+            PoseDistanceTolerance = 32,
+
+            [SpatializerParameter(label = "Head pose output latency", description = "Output latency of the audio device: time from when the plugin renders a block until it is heard. Head poses passed to SetHeadPose are predicted this far ahead. Raise it if sound lags behind head turns on a device with a long output path.", units = "s", min = 0.0f, max = 0.2f, defaultValue = 0.02f)]
+            HeadPoseOutputLatency = 33,
+
         };
-        public const int NumParameters = 22;
+        public const int NumParameters = 34;
 
         public const int NumSourceParameters = (int)Parameter.EnableDistanceAttenuationReverb + 1;
 
@@ -147,6 +221,15 @@ namespace API_3DTI
         [SerializeField]
         private float[] spatializerParameters = Enumerable.Range(0, NumParameters).Select(i => ((Parameter)i).GetAttribute<SpatializerParameterAttribute>().defaultValue).ToArray<float>();
 
+        // Reused to copy scene snapshots into the plugin's buffer
+        private int[] sceneHandles = new int[0];
+        private float[] scenePositionX = new float[0];
+        private float[] scenePositionY = new float[0];
+        private float[] scenePositionZ = new float[0];
+
+        // Reused by batched updates so they don't allocate every frame
+        private ParameterValue[] parameterBatch = new ParameterValue[NumParameters];
+
         /// Array is for the three different sample rates
         [SerializeField]
         private string[] highQualityHRTFPaths =
@@ -197,12 +280,140 @@ namespace API_3DTI
         [DllImport(DLL_NAME)]
         private static extern bool BRTSpatialiserLoadBinary(int role, string path, int sampleRate, int dspBufferSize);
 
+        [DllImport(DLL_NAME)]
+        private static extern int BRTSpatialiserLoadBinaryAsync(int role, string path, int sampleRate, int dspBufferSize);
+
+        [DllImport(DLL_NAME)]
+        private static extern int BRTSpatialiserGetLoadStatus(int job, out float progress);
+
+        [DllImport(DLL_NAME)]
+        private static extern void BRTSpatialiserReleaseLoadJob(int job);
+
+        [DllImport(DLL_NAME)]
+        private static extern ulong BRTSpatialiserGetTableMemory(int role);
+
+        [DllImport(DLL_NAME)]
+        private static extern uint BRTSpatialiserAddListener();
+
+        [DllImport(DLL_NAME)]
+        private static extern bool BRTSpatialiserRemoveListener(uint listener);
+
+        [DllImport(DLL_NAME)]
+        private static extern bool BRTSpatialiserSetListenerTransform(uint listener, float positionX, float positionY, float positionZ, float rotationW, float rotationX, float rotationY, float rotationZ);
+
+        [DllImport(DLL_NAME)]
+        private static extern int BRTSpatialiserLoadListenerBinaryAsync(uint listener, int role, string path, int sampleRate, int dspBufferSize);
+
+        [DllImport(DLL_NAME)]
+        private static extern bool BRTSpatialiserResetListenerBinary(uint listener, int role);
+
         [DllImport(DLL_NAME)]
         private static extern bool BRTSpatialiserSetFloat(int parameterID, float value);
 
         [DllImport(DLL_NAME)]
         private static extern bool BRTSpatialiserGetFloat(int parameterID, out float value);
 
+        // Must match ParameterValue in SpatialiserCore.h
+        [StructLayout(LayoutKind.Sequential)]
+        private struct ParameterValue
+        {
+            public int parameter;
+            public float value;
+        }
+
+        // Each value is replaced with the one the plugin applied, or NaN for an unknown parameter
+        [DllImport(DLL_NAME)]
+        private static extern int BRTSpatialiserSetFloats([In, Out] ParameterValue[] values, int count);
+
+        /// <summary>
+        /// One buffer of a scene snapshot. Must match SceneBuffer in SceneSnapshot.h.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct SceneBuffer
+        {
+            public IntPtr sources;      // uint handles from GetSourceHandle
+            public IntPtr positionX;    // float world positions
+            public IntPtr positionY;
+            public IntPtr positionZ;
+            public IntPtr parameters;   // float per-source parameter p of source i at p * capacity + i, NaN to leave unchanged
+            public int capacity;
+            public int numSources;
+            public int hasParameters;
+        }
+
+        /// <summary>
+        /// Timing of the native audio callbacks over the last 512 blocks. Times are in milliseconds. Must match EngineStats
+        /// in PerformanceMonitor.h.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct EngineStats
+        {
+            public float deadline;          // Duration of one block of audio
+            public float blockTimeMin;
+            public float blockTimeMean;
+            public float blockTimeP99;
+            public float blockTimeMax;
+            // Mean time of each stage: source input (spatializer callbacks), resource installation, BRT rendering, output mixing
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+            public float[] stageTimeMean;
+            public float load;              // blockTimeMean / deadline
+            public uint activeSources;
+            public uint idleSources;        // Pooled sources not claimed by an AudioSource
+            public uint numBlocks;
+            public uint windowOverruns;     // Blocks that took longer than the deadline
+            public uint totalOverruns;
+        }
+
+        [DllImport(DLL_NAME)]
+        private static extern bool BRTSpatialiserGetStats(out EngineStats stats);
+
+        /// <summary>
+        /// State of the adaptive quality controller. Must match QualityState in QualityController.h.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct QualityState
+        {
+            public float load;                  // Smoothed processing time / block duration
+            public QualityLevel level;
+            public uint numDegrades;            // Steps down since the plugin was created
+            public uint numRestores;
+            public uint sourcesWithoutReverb;   // Sources currently taken off the reverb
+            public uint economySources;         // Sources currently repositioned less often
+        }
+
+        [DllImport(DLL_NAME)]
+        private static extern bool BRTSpatialiserGetQualityState(out QualityState state);
+
+        /// <summary>
+        /// A tracked head pose. Must match HeadPose in HeadPose.h.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct HeadPose
+        {
+            public double timestamp;        // Seconds on GetHeadPoseClock when the pose was sampled
+            public Vector3 position;        // World position
+            public float rotationW;         // World rotation, stored w first
+            public float rotationX;
+            public float rotationY;
+            public float rotationZ;
+            public Vector3 angularVelocity; // Radians per second about the world axes
+        }
+
+        [DllImport(DLL_NAME)]
+        private static extern void BRTSpatialiserSetHeadPose(ref HeadPose pose);
+
+        [DllImport(DLL_NAME, EntryPoint = "BRTSpatialiserSetHeadPose")]
+        private static extern void BRTSpatialiserClearHeadPose(IntPtr pose);
+
+        [DllImport(DLL_NAME)]
+        private static extern double BRTSpatialiserGetHeadPoseClock();
+
+        [DllImport(DLL_NAME)]
+        private static extern IntPtr BRTSpatialiserGetSceneBuffer();
+
+        [DllImport(DLL_NAME)]
+        private static extern IntPtr BRTSpatialiserPublishScene();
+
         // Test if a Spatializer instance has been created. This can only be done by adding the SpatializerCore 
         // effect to a mixer. Currently only one instance is supported
         [DllImport(DLL_NAME)]
@@ -236,14 +447,7 @@ namespace API_3DTI
                 AudioSettings.GetDSPBufferSize(out int dspBufferSize, out _);
                 BRTSpatialiserResetIfNeeded(AudioSettings.outputSampleRate, dspBufferSize);
                 sendAllBinaryResourcePathsToPlugin();
-
-                for (int i = 0; i < NumParameters; i++)
-                {
-                    if (!BRTSpatialiserSetFloat(i, spatializerParameters[i]))
-                    {
-                        Debug.LogError($"Failed to set 3DTI parameter {i}.", this);
-                    }
-                }
+                sendAllParametersToPlugin();
                 isInitialized = true;
             }
         }
@@ -254,19 +458,311 @@ namespace API_3DTI
 
             if (BRTSpatialiserResetIfNeeded(AudioSettings.outputSampleRate, dspBufferSize))
             {
-                for (int i = 0; i < NumParameters; i++)
-                {
-                    if (!BRTSpatialiserSetFloat(i, spatializerParameters[i]))
-                    {
-                        Debug.LogError($"Failed to set 3DTI parameter {i}.", this);
-                    }
-                }
+                sendAllParametersToPlugin();
                 sendAllBinaryResourcePathsToPlugin();
             }
 
             
         }
 
+        void Update()
+        {
+            pollBinaryLoadJobs();
+        }
+
+        void OnDestroy()
+        {
+            foreach (int job in binaryLoadJobs.Values)
+            {
+                BRTSpatialiserReleaseLoadJob(job);
+            }
+            binaryLoadJobs.Clear();
+
+            foreach (int job in listenerBinaryLoadJobs.Values)
+            {
+                BRTSpatialiserReleaseLoadJob(job);
+            }
+            listenerBinaryLoadJobs.Clear();
+        }
+
+        /// <summary>
+        /// True while any binary resource is still being loaded in the background.
+        /// </summary>
+        public bool IsLoadingBinaryResources => binaryLoadJobs.Count > 0 || listenerBinaryLoadJobs.Count > 0;
+
+        /// <summary>
+        /// Progress between 0 and 1 of the background load of the resource for the given role. Returns 1 if nothing is loading for that role.
+        /// </summary>
+        public float GetBinaryResourceLoadProgress(BinaryResourceRole role)
+        {
+            if (binaryLoadJobs.TryGetValue(role, out int job) && BRTSpatialiserGetLoadStatus(job, out float progress) != (int)BinaryLoadStatus.InvalidHandle)
+            {
+                return progress;
+            }
+            return 1.0f;
+        }
+
+        /// <summary>
+        /// Approximate memory in bytes used by the loaded table for the given role. For the HRTF and BRIR this grows with the
+        /// square of 1 / HRTFResamplingStep, so a coarser step trades spatial resolution for memory and load time.
+        /// </summary>
+        public ulong GetBinaryResourceMemoryUsage(BinaryResourceRole role)
+        {
+            return BRTSpatialiserGetTableMemory((int)role);
+        }
+
+        // --- Handles
+
+        /// <summary>
+        /// Returned by the plugin when a source or listener could not be found or created.
+        /// </summary>
+        public const uint InvalidHandle = 0;
+
+        /// <summary>
+        /// The plugin's handle for the source spatialized by this AudioSource, or InvalidHandle if it is not spatialized.
+        /// A handle stops being valid when its AudioSource is destroyed, even if the plugin reuses the source for another.
+        /// </summary>
+        public static uint GetSourceHandle(AudioSource source)
+        {
+            return source.GetSpatializerFloat(NumSourceParameters, out float handle) ? (uint)handle : InvalidHandle;
+        }
+
+        /// <summary>
+        /// The value to set on the Listener parameter of a "BRT Listener Output" effect to hear the listener with this handle.
+        /// The whole handle is passed, so the effect goes silent rather than playing another listener once this one is removed.
+        /// </summary>
+        public static float GetListenerOutputValue(uint listener)
+        {
+            return (float)listener;
+        }
+
+        /// <summary>
+        /// Native CPU time spent rendering audio. The same figures can be read from the BRT Manager effect's "Stats" float
+        /// buffer, and the recent block times from its "BlockTimes" buffer.
+        /// </summary>
+        /// <returns>False if the plugin has not been created yet</returns>
+        public bool GetEngineStats(out EngineStats stats)
+        {
+            return BRTSpatialiserGetStats(out stats);
+        }
+
+        /// <summary>
+        /// The quality level picked by adaptive quality and what it currently applies to. Configure it with the AdaptiveQuality
+        /// parameters. The same figures can be read from the BRT Manager effect's "Quality" float buffer.
+        /// </summary>
+        /// <returns>False if the plugin has not been created yet</returns>
+        public bool GetQualityState(out QualityState state)
+        {
+            return BRTSpatialiserGetQualityState(out state);
+        }
+
+        // --- Scene snapshot
+
+        /// <summary>
+        /// The plugin buffer to fill with the next scene snapshot, for writing directly from a Burst job or unsafe code. It
+        /// points to a <see cref="SceneBuffer"/> and stays valid until <see cref="PublishScene()"/> is called.
+        /// </summary>
+        public IntPtr GetSceneBuffer()
+        {
+            return BRTSpatialiserGetSceneBuffer();
+        }
+
+        /// <summary>
+        /// Hands the buffer returned by <see cref="GetSceneBuffer"/> to the audio thread. Sources in the snapshot take their
+        /// position from it until a snapshot without them is published, rather than from their AudioSource.
+        /// </summary>
+        public void PublishScene()
+        {
+            BRTSpatialiserPublishScene();
+        }
+
+        /// <summary>
+        /// Positions count sources with a single snapshot. Cheaper than letting each spatializer decode its own transform
+        /// when many sources move every frame.
+        /// </summary>
+        /// <param name="sourceHandles">Handles from <see cref="GetSourceHandle"/></param>
+        /// <param name="positions">World positions of the sources</param>
+        public void PublishScene(uint[] sourceHandles, Vector3[] positions, int count)
+        {
+            IntPtr bufferPointer = BRTSpatialiserGetSceneBuffer();
+            SceneBuffer buffer = Marshal.PtrToStructure<SceneBuffer>(bufferPointer);
+            count = Math.Min(count, buffer.capacity);
+
+            if (sceneHandles.Length < count)
+            {
+                sceneHandles = new int[count];
+                scenePositionX = new float[count];
+                scenePositionY = new float[count];
+                scenePositionZ = new float[count];
+            }
+            for (int i = 0; i < count; i++)
+            {
+                sceneHandles[i] = (int)sourceHandles[i];
+                scenePositionX[i] = positions[i].x;
+                scenePositionY[i] = positions[i].y;
+                scenePositionZ[i] = positions[i].z;
+            }
+
+            Marshal.Copy(sceneHandles, 0, buffer.sources, count);
+            Marshal.Copy(scenePositionX, 0, buffer.positionX, count);
+            Marshal.Copy(scenePositionY, 0, buffer.positionY, count);
+            Marshal.Copy(scenePositionZ, 0, buffer.positionZ, count);
+            Marshal.WriteInt32(bufferPointer, (int)Marshal.OffsetOf<SceneBuffer>("numSources"), count);
+            BRTSpatialiserPublishScene();
+        }
+
+        // --- Head pose
+
+        /// <summary>
+        /// Sets the main listener from a tracked head pose, bypassing the AudioListener transform that only reaches the audio
+        /// thread once per frame and a buffer late. Call it from the XR tracking callback (e.g. InputTracking or an
+        /// XRInputSubsystem update) with every new pose; it never blocks. The audio thread predicts the pose forward to when each
+        /// block will be heard using the angular velocity. If no pose arrives for a quarter of a second, or after
+        /// <see cref="ClearHeadPose"/>, the listener follows the AudioListener again.
+        /// </summary>
+        /// <param name="age">Seconds since the tracker sampled the pose, if known</param>
+        public void SetHeadPose(Vector3 position, Quaternion rotation, Vector3 angularVelocity, double age = 0.0)
+        {
+            HeadPose pose = new HeadPose
+            {
+                timestamp = BRTSpatialiserGetHeadPoseClock() - age,
+                position = position,
+                rotationW = rotation.w,
+                rotationX = rotation.x,
+                rotationY = rotation.y,
+                rotationZ = rotation.z,
+                angularVelocity = angularVelocity,
+            };
+            BRTSpatialiserSetHeadPose(ref pose);
+        }
+
+        /// <summary>
+        /// Sets the main listener from a head pose whose timestamp is already on <see cref="GetHeadPoseClock"/>.
+        /// </summary>
+        public void SetHeadPose(ref HeadPose pose)
+        {
+            BRTSpatialiserSetHeadPose(ref pose);
+        }
+
+        /// <summary>
+        /// Makes the main listener follow the AudioListener again.
+        /// </summary>
+        public void ClearHeadPose()
+        {
+            BRTSpatialiserClearHeadPose(IntPtr.Zero);
+        }
+
+        /// <summary>
+        /// Current time in seconds on the clock <see cref="HeadPose"/> timestamps are measured on.
+        /// </summary>
+        public double GetHeadPoseClock()
+        {
+            return BRTSpatialiserGetHeadPoseClock();
+        }
+
+        // --- Additional listeners
+
+        /// <summary>
+        /// Adds a listener that hears every spatialized source from its own pose. Its output is played by a "BRT Listener Output"
+        /// effect whose Listener parameter is set to <see cref="GetListenerOutputValue"/> of the returned handle. The new listener starts
+        /// with the same binary resources as the main AudioListener.
+        /// </summary>
+        /// <returns>Handle of the new listener, or InvalidHandle if no more listeners can be added</returns>
+        public uint AddListener()
+        {
+            return BRTSpatialiserAddListener();
+        }
+
+        /// <summary>
+        /// Removes a listener added with <see cref="AddListener"/>.
+        /// </summary>
+        public bool RemoveListener(uint listener)
+        {
+            return BRTSpatialiserRemoveListener(listener);
+        }
+
+        /// <summary>
+        /// Moves an additional listener to the position and rotation of the given transform.
+        /// </summary>
+        public bool SetListenerTransform(uint listener, Transform listenerTransform)
+        {
+            Vector3 p = listenerTransform.position;
+            Quaternion q = listenerTransform.rotation;
+            return BRTSpatialiserSetListenerTransform(listener, p.x, p.y, p.z, q.w, q.x, q.y, q.z);
+        }
+
+        /// <summary>
+        /// Gives an additional listener its own binary resource, e.g. a different HRTF, instead of following the main listener.
+        /// The resource is loaded in the background and the listener keeps its current one until it is ready.
+        /// </summary>
+        /// <param name="path">Resource path as for <see cref="SetBinaryResourcePath"/>. Leave empty to follow the main listener again.</param>
+        /// <returns>False if the resource could not be found or its load could not be started.</returns>
+        public bool SetListenerBinaryResource(uint listener, BinaryResourceRole role, string path)
+        {
+            if (listenerBinaryLoadJobs.TryGetValue((listener, role), out int previousJob))
+            {
+                // The plugin supersedes the previous request itself, we just stop tracking it
+                BRTSpatialiserReleaseLoadJob(previousJob);
+                listenerBinaryLoadJobs.Remove((listener, role));
+            }
+
+            if (path.Length == 0)
+            {
+                return BRTSpatialiserResetListenerBinary(listener, (int)role);
+            }
+            if (!SaveResourceAsFile(path, out string newPath))
+            {
+                return false;
+            }
+
+            AudioSettings.GetDSPBufferSize(out int dspBufferSize, out _);
+            int job = BRTSpatialiserLoadListenerBinaryAsync(listener, (int)role, newPath, AudioSettings.outputSampleRate, dspBufferSize);
+            if (job == 0)
+            {
+                return false;
+            }
+            listenerBinaryLoadJobs[(listener, role)] = job;
+            return true;
+        }
+
+        private void pollBinaryLoadJobs()
+        {
+            foreach (BinaryResourceRole role in binaryLoadJobs.Keys.ToList())
+            {
+                if (isLoadJobFinished(binaryLoadJobs[role], $"{role}"))
+                {
+                    binaryLoadJobs.Remove(role);
+                }
+            }
+
+            foreach (var key in listenerBinaryLoadJobs.Keys.ToList())
+            {
+                if (isLoadJobFinished(listenerBinaryLoadJobs[key], $"{key.role} of listener {key.listener}"))
+                {
+                    listenerBinaryLoadJobs.Remove(key);
+                }
+            }
+        }
+
+        // Releases the job and returns true once it no longer needs polling
+        private bool isLoadJobFinished(int job, string description)
+        {
+            BinaryLoadStatus status = (BinaryLoadStatus)BRTSpatialiserGetLoadStatus(job, out _);
+            switch (status)
+            {
+                case BinaryLoadStatus.Queued:
+                case BinaryLoadStatus.InProgress:
+                case BinaryLoadStatus.Ready:
+                    return false;
+                case BinaryLoadStatus.Failed:
+                case BinaryLoadStatus.InvalidHandle:
+                    Debug.LogError($"Failed to load Spatializer binary resource for {description} at sample rate {AudioSettings.outputSampleRate}.", this);
+                    break;
+            }
+            BRTSpatialiserReleaseLoadJob(job);
+            return true;
+        }
+
         // --- Spatializer Core parameters
 
         /// <summary>
@@ -320,6 +816,63 @@ namespace API_3DTI
             return true;
         }
 
+        /// <summary>
+        /// Sets several Spatializer Core parameters with a single call into the plugin. They are applied together, so the
+        /// audio thread sees them all change in the same block and a table affected by several of them is only rebuilt once.
+        /// Cheaper than calling <see cref="SetFloatParameter"/> for each when automating parameters every frame.
+        /// </summary>
+        /// <returns>True if every parameter was set</returns>
+        public bool SetFloatParameters(Parameter[] parameters, float[] values)
+        {
+            Debug.Assert(parameters.Length == values.Length);
+            int count = Math.Min(parameters.Length, values.Length);
+            if (parameterBatch.Length < count)
+            {
+                parameterBatch = new ParameterValue[count];
+            }
+            for (int i = 0; i < count; i++)
+            {
+                parameterBatch[i].parameter = (int)parameters[i];
+                parameterBatch[i].value = values[i];
+            }
+
+            int numSet = BRTSpatialiserSetFloats(parameterBatch, count);
+            storeAppliedParameters(count);
+            if (numSet != count)
+            {
+                Debug.LogError($"Failed to set {count - numSet} of {count} parameters on 3DTI Spatializer plugin.", this);
+                return false;
+            }
+            return true;
+        }
+
+        private void sendAllParametersToPlugin()
+        {
+            for (int i = 0; i < NumParameters; i++)
+            {
+                parameterBatch[i].parameter = i;
+                parameterBatch[i].value = spatializerParameters[i];
+            }
+            int numSet = BRTSpatialiserSetFloats(parameterBatch, NumParameters);
+            if (numSet != NumParameters)
+            {
+                Debug.LogError($"Failed to set {NumParameters - numSet} 3DTI parameters.", this);
+            }
+        }
+
+        // Refreshes the serialized values with whatever the plugin actually applied, as returned in the batch
+        private void storeAppliedParameters(int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                int parameter = parameterBatch[i].parameter;
+                if (parameter >= 0 && parameter < NumParameters && !float.IsNaN(parameterBatch[i].value))
+                {
+                    spatializerParameters[parameter] = parameterBatch[i].value;
+                }
+            }
+        }
+
         /// <summary>
         /// Gets the value of a parameter in its raw float form.
         /// </summary>
@@ -448,11 +1001,34 @@ namespace API_3DTI
             Debug.Log("sendBinaryResourcePathToPlugin: " + path);
             AudioSettings.GetDSPBufferSize(out int dspBufferSize, out _);
 
+            if (binaryLoadJobs.TryGetValue(role, out int previousJob))
+            {
+                // The plugin supersedes the previous request itself, we just stop tracking it
+                BRTSpatialiserReleaseLoadJob(previousJob);
+                binaryLoadJobs.Remove(role);
+            }
+
             if (path.Length == 0)
             {
                 BRTSpatialiserLoadBinary((int)role, path, AudioSettings.outputSampleRate, dspBufferSize);
             }
-            else if (!(SaveResourceAsFile(path, out string newPath) && BRTSpatialiserLoadBinary((int)role, newPath, AudioSettings.outputSampleRate, dspBufferSize)))
+            else if (!SaveResourceAsFile(path, out string newPath))
+            {
+                Debug.LogError($"Failed to load Spatializer binary resource {path} for {role} at sample rate {AudioSettings.outputSampleRate}.");
+            }
+            else if (loadBinaryResourcesAsynchronously)
+            {
+                int job = BRTSpatialiserLoadBinaryAsync((int)role, newPath, AudioSettings.outputSampleRate, dspBufferSize);
+                if (job == 0)
+                {
+                    Debug.LogError($"Failed to start loading Spatializer binary resource {path} for {role} at sample rate {AudioSettings.outputSampleRate}.");
+                }
+                else
+                {
+                    binaryLoadJobs[role] = job;
+                }
+            }
+            else if (!BRTSpatialiserLoadBinary((int)role, newPath, AudioSettings.outputSampleRate, dspBufferSize))
             {
                 Debug.LogError($"Failed to load Spatializer binary resource {path} for {role} at sample rate {AudioSettings.outputSampleRate}.");
                 // return false;
@@ -0,0 +1,130 @@
+// Measures the cost of reading HRIR tables held in 16 bit formats against plain floats, and the error the
+// formats introduce. The workload mirrors HRIRMeasurementSet::interpolate: accumulating a weighted handful of
+// measurements out of a table too large for the caches.
+//
+// Usage: HalfFloatBenchmark [irLength] [numMeasurements]
+
+#include "HalfFloat.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace BRTHelpers;
+
+namespace
+{
+    const char* FormatName (SampleFormat format)
+    {
+        switch (format)
+        {
+            case SampleFormat::Float32:  return "float32";
+            case SampleFormat::Float16:  return "float16";
+            case SampleFormat::BFloat16: return "bfloat16";
+        }
+        return "?";
+    }
+
+    // Exponentially decaying noise, roughly the shape of a measured HRIR
+    std::vector<float> MakeTable (size_t irLength, size_t numMeasurements)
+    {
+        std::mt19937 random (1234);
+        std::normal_distribution<float> noise (0.0f, 0.25f);
+
+        std::vector<float> table (irLength * numMeasurements);
+        for (size_t m = 0; m < numMeasurements; ++m)
+            for (size_t i = 0; i < irLength; ++i)
+                table[m * irLength + i] = noise (random) * std::exp (-8.0f * (float) i / (float) irLength);
+        return table;
+    }
+
+    // Signal to error ratio in dB of the table after a round trip through format
+    double RoundTripSNR (const std::vector<float>& table, SampleFormat format)
+    {
+        std::vector<uint16_t> packed (table.size());
+        PackSamples (table.data(), packed.data(), table.size(), format);
+
+        std::vector<float> widened (table.size(), 0.0f);
+        AccumulateWeighted (widened.data(), packed.data(), table.size(), 1.0f, format);
+
+        double signal = 0.0, error = 0.0;
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            signal += (double) table[i] * table[i];
+            error += ((double) table[i] - widened[i]) * ((double) table[i] - widened[i]);
+        }
+        return 10.0 * std::log10 (signal / std::max (error, 1e-300));
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    const size_t irLength = argc > 1 ? (size_t) std::atoi (argv[1]) : 1024;         // Both ears of a 512 sample HRIR
+    const size_t numMeasurements = argc > 2 ? (size_t) std::atoi (argv[2]) : 2000;  // ~8 MB as float
+    const int numLookups = 200000;
+    const int neighboursPerLookup = 4;
+
+    const std::vector<float> table = MakeTable (irLength, numMeasurements);
+
+    std::mt19937 random (42);
+    std::uniform_int_distribution<size_t> pick (0, numMeasurements - 1);
+    std::vector<size_t> lookups ((size_t) numLookups * neighboursPerLookup);
+    for (auto& m : lookups)
+        m = pick (random);
+
+    std::printf ("%zu measurements of %zu samples, %d lookups of %d measurements\n\n",
+                 numMeasurements, irLength, numLookups, neighboursPerLookup);
+    std::printf ("%-10s %10s %12s %10s %10s\n", "format", "table MB", "ns/lookup", "speedup", "SNR dB");
+
+    double floatTime = 0.0;
+    for (SampleFormat format : { SampleFormat::Float32, SampleFormat::Float16, SampleFormat::BFloat16 })
+    {
+        std::vector<uint16_t> packed;
+        if (format != SampleFormat::Float32)
+        {
+            packed.resize (table.size());
+            PackSamples (table.data(), packed.data(), table.size(), format);
+        }
+
+        std::vector<float> output (irLength);
+        float checksum = 0.0f;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int l = 0; l < numLookups; ++l)
+        {
+            std::fill (output.begin(), output.end(), 0.0f);
+            for (int n = 0; n < neighboursPerLookup; ++n)
+            {
+                const size_t offset = lookups[(size_t) l * neighboursPerLookup + n] * irLength;
+                const float weight = 1.0f / (float) (n + 1);
+
+                if (format == SampleFormat::Float32)
+                {
+                    const float* source = table.data() + offset;
+                    for (size_t i = 0; i < irLength; ++i)
+                        output[i] += weight * source[i];
+                }
+                else
+                {
+                    AccumulateWeighted (output.data(), packed.data() + offset, irLength, weight, format);
+                }
+            }
+            checksum += output[(size_t) l % irLength];
+        }
+        const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+
+        const double nsPerLookup = 1e9 * seconds / numLookups;
+        if (format == SampleFormat::Float32)
+            floatTime = nsPerLookup;
+
+        const size_t bytes = format == SampleFormat::Float32 ? table.size() * sizeof (float) : packed.size() * sizeof (uint16_t);
+        const double snr = format == SampleFormat::Float32 ? INFINITY : RoundTripSNR (table, format);
+
+        std::printf ("%-10s %10.2f %12.1f %9.2fx %10.1f   (checksum %g)\n", FormatName (format),
+                     bytes / (1024.0 * 1024.0), nsPerLookup, floatTime / nsPerLookup, snr, checksum);
+    }
+    return 0;
+}
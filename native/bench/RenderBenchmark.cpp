@@ -0,0 +1,420 @@
+// Measures the render hot path through the plugin's own callbacks and writes the results as JSON, so runs of
+// different plugin versions can be compared. Covers:
+//
+//   process     One block of every source's spatialiser ProcessCallback followed by the BRT Manager's, for each
+//               number of sources, buffer size, static or moving sources, reverb off or on and spatialisation mode
+//   sofaLoad    BRTSpatialiserLoadBinary for each resource given. Only the first load of a file is cold, later
+//               ones are served by the ResourceRegistry.
+//   fft         FFT::Forward at single and double precision
+//   meter       Meter::process, with and without the spectrum
+//   downmix     DownmixStereo
+//   interleave  InterleaveStereo
+//
+// The process cases need at least an HRTF. Reverb cases only run when a BRIR is given. Set BRT_CPU_LEVEL to
+// baseline, sse4.2 or avx2 to compare the SIMD kernel variants on one machine.
+//
+// Usage: RenderBenchmark --hrtf file.sofa [--ild file.sofa] [--hp-ild file.sofa] [--brir file.sofa]
+//                        [--samplerate 48000] [--sources 1,10,100,1000] [--buffers 64,128,256,512,1024,2048]
+//                        [--min-time 0.2] [--quick] [--output results.json]
+
+#include "SpatialiserCore.h"
+#include "CpuFeatures.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef BRT_PLUGIN_VERSION
+#define BRT_PLUGIN_VERSION "unknown"
+#endif
+
+using namespace BRTSpatialiserCore;
+
+extern "C" bool BRTSpatialiserResetIfNeeded (int sampleRate, int dspBufferSize);
+extern "C" bool BRTSpatialiserLoadBinary (BinaryRole role, const char* path, int currentSampleRate, int dspBufferSize);
+extern "C" bool BRTSpatialiserSetFloat (int parameter, float value);
+
+namespace
+{
+    struct Options
+    {
+        std::vector<std::pair<BinaryRole, std::string>> resources;
+        int sampleRate = 48000;
+        std::vector<int> numSources { 1, 10, 100, 1000 };
+        std::vector<int> bufferSizes { 64, 128, 256, 512, 1024, 2048 };
+        double minTime = 0.2;
+        std::string output;
+    };
+
+    std::vector<int> ParseList (const char* text)
+    {
+        std::vector<int> values;
+        std::stringstream list (text);
+        for (std::string item; std::getline (list, item, ',');)
+            values.push_back (std::atoi (item.c_str()));
+        return values;
+    }
+
+    bool HasResource (const Options& options, BinaryRole role)
+    {
+        for (const auto& resource : options.resources)
+            if (resource.first == role)
+                return true;
+        return false;
+    }
+
+    // Calls body until at least minTime has passed, after a couple of untimed calls, and returns the mean
+    // nanoseconds per call
+    template <typename Body>
+    double MeasureNs (Body&& body, double minTime, int minIterations = 5)
+    {
+        body();
+        body();
+
+        int iterations = 0;
+        const auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do
+        {
+            body();
+            ++iterations;
+            seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+        }
+        while (seconds < minTime || iterations < minIterations);
+
+        return 1e9 * seconds / iterations;
+    }
+
+    // Results are kept as JSON objects and joined at the end
+    struct Report
+    {
+        std::vector<std::string> results;
+
+        void add (const std::string& fields)
+        {
+            results.push_back ("    { " + fields + " }");
+            std::fprintf (stderr, "%s\n", fields.c_str());
+        }
+
+        std::string json (const Options& options) const
+        {
+            std::ostringstream out;
+            out << "{\n  \"benchmark\": \"RenderBenchmark\",\n  \"pluginVersion\": \"" << BRT_PLUGIN_VERSION
+                << "\",\n  \"cpuLevel\": \"" << BRTHelpers::GetCpuLevelName (BRTHelpers::GetCpuLevel())
+                << "\",\n  \"sampleRate\": " << options.sampleRate << ",\n  \"results\": [\n";
+            for (size_t i = 0; i < results.size(); ++i)
+                out << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+            out << "  ]\n}\n";
+            return out.str();
+        }
+    };
+
+    std::string Field (const char* name, double value)
+    {
+        char text[96];
+        std::snprintf (text, sizeof (text), "\"%s\": %.6g", name, value);
+        return text;
+    }
+
+    std::string Field (const char* name, const char* value)
+    {
+        return std::string ("\"") + name + "\": \"" + value + "\"";
+    }
+
+    std::string Field (const char* name, bool value)
+    {
+        return std::string ("\"") + name + "\": " + (value ? "true" : "false");
+    }
+
+    std::vector<float> Noise (size_t count)
+    {
+        std::mt19937 random (1234);
+        std::uniform_real_distribution<float> noise (-0.5f, 0.5f);
+        std::vector<float> samples (count);
+        for (auto& s : samples)
+            s = noise (random);
+        return samples;
+    }
+
+    //==========================================================================
+    UnityAudioEffectDefinition* FindEffect (const char* name)
+    {
+        UnityAudioEffectDefinition** definitions = nullptr;
+        const int numEffects = UnityGetAudioEffectDefinitions (&definitions);
+        for (int i = 0; i < numEffects; ++i)
+            if (std::strcmp (definitions[i]->name, name) == 0)
+                return definitions[i];
+        return nullptr;
+    }
+
+    // One effect instance, with the state Unity would hand to its callbacks
+    struct Effect
+    {
+        UnityAudioEffectDefinition* definition = nullptr;
+        UnityAudioEffectState state {};
+        UnityAudioSpatializerData spatializerData {};
+        bool isCreated = false;
+
+        bool create (UnityAudioEffectDefinition* d, int sampleRate, int bufferSize)
+        {
+            definition = d;
+            state.structsize = sizeof (UnityAudioEffectState);
+            state.samplerate = (UInt32) sampleRate;
+            state.dspbuffersize = (UInt32) bufferSize;
+            state.hostapiversion = UNITY_AUDIO_PLUGIN_API_VERSION;
+            state.flags = UnityAudioEffectStateFlags_IsPlaying;
+            state.internal = this;
+            state.spatializerdata = &spatializerData;
+            isCreated = definition->create (&state) == UNITY_AUDIODSP_OK;
+            return isCreated;
+        }
+
+        ~Effect()
+        {
+            if (isCreated)
+                definition->release (&state);
+        }
+    };
+
+    // Listener at the origin facing +z, sources on a ring around it
+    void PlaceSource (Effect& source, float angle)
+    {
+        float* l = source.spatializerData.listenermatrix;
+        float* s = source.spatializerData.sourcematrix;
+        std::fill (l, l + 16, 0.0f);
+        std::fill (s, s + 16, 0.0f);
+        l[0] = l[5] = l[10] = l[15] = 1.0f;
+        s[0] = s[5] = s[10] = s[15] = 1.0f;
+        s[12] = 2.0f * std::sin (angle);
+        s[13] = 0.5f * std::sin (3.0f * angle);
+        s[14] = 2.0f * std::cos (angle);
+    }
+
+    void BenchmarkProcess (const Options& options, int bufferSize, Report& report)
+    {
+        UnityAudioEffectDefinition* managerDefinition = FindEffect ("BRT Manager");
+        UnityAudioEffectDefinition* spatialiserDefinition = FindEffect ("BRT Binaural Spatialiser");
+
+        const std::vector<float> input = Noise ((size_t) bufferSize * 2);
+        std::vector<float> scratch ((size_t) bufferSize * 2);
+        std::vector<float> output ((size_t) bufferSize * 2);
+        const double deadlineNs = 1e9 * bufferSize / options.sampleRate;
+
+        const bool hasReverb = HasResource (options, ReverbBRIR);
+        const std::pair<const char*, float> modes[] = { { "none", 0.0f }, { "highPerformance", 1.0f }, { "highQuality", 2.0f } };
+
+        for (const auto& mode : modes)
+        {
+            for (bool isReverbOn : { false, true })
+            {
+                if (isReverbOn && ! hasReverb)
+                    continue;
+
+                // Defaults picked up by every source created below
+                BRTSpatialiserSetFloat (SpatializationMode, mode.second);
+                BRTSpatialiserSetFloat (EnableReverbSend, isReverbOn ? 1.0f : 0.0f);
+                BRTSpatialiserSetFloat (EnableReverbProcessing, isReverbOn ? 1.0f : 0.0f);
+
+                for (int numSources : options.numSources)
+                {
+                    Effect manager;
+                    std::vector<Effect> sources ((size_t) numSources);
+                    bool isCreated = manager.create (managerDefinition, options.sampleRate, bufferSize);
+                    for (int s = 0; s < numSources && isCreated; ++s)
+                    {
+                        isCreated = sources[s].create (spatialiserDefinition, options.sampleRate, bufferSize);
+                        PlaceSource (sources[s], 6.2831853f * (float) s / (float) numSources);
+                    }
+                    if (! isCreated)
+                    {
+                        std::fprintf (stderr, "Failed to create %d sources with buffer size %d\n", numSources, bufferSize);
+                        continue;
+                    }
+
+                    for (bool isMoving : { false, true })
+                    {
+                        float step = 0.0f;
+                        const double ns = MeasureNs ([&]
+                        {
+                            if (isMoving)
+                            {
+                                step += 0.01f;
+                                for (int s = 0; s < numSources; ++s)
+                                    PlaceSource (sources[s], 6.2831853f * (float) s / (float) numSources + step);
+                            }
+                            for (auto& source : sources)
+                                spatialiserDefinition->process (&source.state, const_cast<float*> (input.data()), scratch.data(),
+                                                                (unsigned int) bufferSize, 2, 2);
+                            managerDefinition->process (&manager.state, const_cast<float*> (input.data()), output.data(),
+                                                        (unsigned int) bufferSize, 2, 2);
+                        }, options.minTime);
+
+                        report.add (Field ("name", "process") + ", " + Field ("sources", (double) numSources) + ", "
+                                    + Field ("bufferSize", (double) bufferSize) + ", " + Field ("moving", isMoving) + ", "
+                                    + Field ("reverb", isReverbOn) + ", " + Field ("mode", mode.first) + ", "
+                                    + Field ("nsPerBlock", ns) + ", " + Field ("nsPerSource", ns / numSources) + ", "
+                                    + Field ("load", ns / deadlineNs));
+                    }
+                }
+            }
+        }
+    }
+
+    //==========================================================================
+    void BenchmarkUtilities (const Options& options, Report& report)
+    {
+        for (int size = 256; size <= 4096; size *= 2)
+        {
+            for (bool isHighPrecision : { false, true })
+            {
+                const std::vector<float> noise = Noise ((size_t) size);
+                std::vector<UnityComplexNumber> data ((size_t) size);
+                const double ns = MeasureNs ([&]
+                {
+                    for (int i = 0; i < size; ++i)
+                        data[i].Set (noise[i], 0.0f);
+                    FFT::Forward (data.data(), size, isHighPrecision);
+                }, options.minTime);
+
+                report.add (Field ("name", "fft") + ", " + Field ("size", (double) size) + ", "
+                            + Field ("highPrecision", isHighPrecision) + ", " + Field ("nsPerTransform", ns));
+            }
+        }
+
+        for (int bufferSize : options.bufferSizes)
+        {
+            const std::vector<float> interleaved = Noise ((size_t) bufferSize * 2);
+            std::vector<float> left ((size_t) bufferSize), right ((size_t) bufferSize), stereo ((size_t) bufferSize * 2);
+
+            for (bool hasSpectrum : { false, true })
+            {
+                Meter meter;
+                if (hasSpectrum)
+                {
+                    float bins[Meter::SpectrumBins];
+                    meter.readSpectrum (bins, Meter::SpectrumBins);
+                }
+                const double ns = MeasureNs ([&] { meter.process (interleaved.data(), 2, bufferSize); }, options.minTime);
+                report.add (Field ("name", "meter") + ", " + Field ("bufferSize", (double) bufferSize) + ", "
+                            + Field ("spectrum", hasSpectrum) + ", " + Field ("nsPerBlock", ns)
+                            + ", " + Field ("nsPerFrame", ns / bufferSize));
+            }
+
+            double ns = MeasureNs ([&] { BRTHelpers::DownmixStereo (interleaved.data(), left.data(), (size_t) bufferSize); }, options.minTime);
+            report.add (Field ("name", "downmix") + ", " + Field ("bufferSize", (double) bufferSize) + ", "
+                        + Field ("nsPerBlock", ns) + ", " + Field ("nsPerFrame", ns / bufferSize));
+
+            ns = MeasureNs ([&] { BRTHelpers::InterleaveStereo (left.data(), right.data(), stereo.data(), (size_t) bufferSize); }, options.minTime);
+            report.add (Field ("name", "interleave") + ", " + Field ("bufferSize", (double) bufferSize) + ", "
+                        + Field ("nsPerBlock", ns) + ", " + Field ("nsPerFrame", ns / bufferSize));
+        }
+    }
+
+    bool LoadResources (const Options& options, int bufferSize, bool isFirstLoad, Report& report)
+    {
+        for (const auto& resource : options.resources)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const bool isLoaded = BRTSpatialiserLoadBinary (resource.first, resource.second.c_str(), options.sampleRate, bufferSize);
+            const double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+            if (! isLoaded)
+            {
+                std::fprintf (stderr, "Failed to load %s\n", resource.second.c_str());
+                return false;
+            }
+
+            report.add (Field ("name", "sofaLoad") + ", " + Field ("role", (double) resource.first) + ", "
+                        + Field ("file", resource.second.c_str()) + ", " + Field ("cold", isFirstLoad) + ", "
+                        + Field ("bufferSize", (double) bufferSize) + ", " + Field ("ms", ms));
+        }
+        return true;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--quick")
+        {
+            options.numSources = { 1, 100 };
+            options.bufferSizes = { 512 };
+            options.minTime = 0.05;
+            continue;
+        }
+        if (value == nullptr)
+        {
+            std::fprintf (stderr, "Missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        ++i;
+        if (arg == "--hrtf")             options.resources.emplace_back (HighQualityHRTF, value);
+        else if (arg == "--ild")         options.resources.emplace_back (HighQualityILD, value);
+        else if (arg == "--hp-ild")      options.resources.emplace_back (HighPerformanceILD, value);
+        else if (arg == "--brir")        options.resources.emplace_back (ReverbBRIR, value);
+        else if (arg == "--samplerate")  options.sampleRate = std::atoi (value);
+        else if (arg == "--sources")     options.numSources = ParseList (value);
+        else if (arg == "--buffers")     options.bufferSizes = ParseList (value);
+        else if (arg == "--min-time")    options.minTime = std::atof (value);
+        else if (arg == "--output")      options.output = value;
+        else
+        {
+            std::fprintf (stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    Report report;
+    BenchmarkUtilities (options, report);
+
+    if (! HasResource (options, HighQualityHRTF))
+    {
+        std::fprintf (stderr, "No --hrtf given, skipping the sofaLoad and process cases\n");
+    }
+    else
+    {
+        int maxSources = 0;
+        for (int n : options.numSources)
+            maxSources = std::max (maxSources, n);
+
+        bool isFirstLoad = true;
+        for (int bufferSize : options.bufferSizes)
+        {
+            // A new buffer size needs a new core, which has to load everything again
+            BRTSpatialiserResetIfNeeded (options.sampleRate, bufferSize);
+            if (! LoadResources (options, bufferSize, isFirstLoad, report))
+                return 1;
+            isFirstLoad = false;
+
+            BRTSpatialiserSetFloat (SourcePoolSize, (float) maxSources);
+            // Every case is measured at full quality
+            BRTSpatialiserSetFloat (EnableAdaptiveQuality, 0.0f);
+            BenchmarkProcess (options, bufferSize, report);
+        }
+    }
+
+    const std::string json = report.json (options);
+    if (options.output.empty())
+    {
+        std::fputs (json.c_str(), stdout);
+    }
+    else if (FILE* file = std::fopen (options.output.c_str(), "w"))
+    {
+        std::fputs (json.c_str(), file);
+        std::fclose (file);
+    }
+    else
+    {
+        std::fprintf (stderr, "Cannot write %s\n", options.output.c_str());
+        return 1;
+    }
+    return 0;
+}
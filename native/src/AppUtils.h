@@ -1,15 +1,20 @@
 
+#include <chrono>
 #include <string>
+#include "HRTFResampler.h"
 
 #ifndef _APP_UTILS_HPP_
 #define _APP_UTILS_HPP_
 
+// Default HRTF/BRIR grid resampling step in degrees. Can be changed at runtime with the HRTFResamplingStep parameter.
 #define HRTFRESAMPLINGSTEP 15
 
 class AppUtils
 {
 public:
-    static bool LoadHRTFSofaFile(const std::string & _filePath, std::shared_ptr<BRTServices::CHRTF> hrtf) {
+    // If measurements is given the grid is resampled from it rather than from the file itself
+    static bool LoadHRTFSofaFile(const std::string & _filePath, std::shared_ptr<BRTServices::CHRTF> hrtf, int _resamplingStep = HRTFRESAMPLINGSTEP
+        , const BRTSpatialiserCore::HRIRMeasurementSet* measurements = nullptr, std::atomic<float>* progress = nullptr) {
                 
         BRTReaders::CSOFAReader sofaReader;
         Common::CGlobalParameters globalParameters;
@@ -25,9 +30,25 @@ public:
             return false;
         }
         std::cout << std::endl << "Loading HRTF SOFA File....." << std::endl << std::endl;
-        bool result = sofaReader.ReadHRTFFromSofa(_filePath, hrtf, HRTFRESAMPLINGSTEP, BRTServices::TEXTRAPOLATION_METHOD::nearest_point);
+        const auto startTime = std::chrono::steady_clock::now();
+        bool result;
+        // Resample the grid across all cores ourselves. BRT's reader does the same work on a single thread
+        // so it is only used for files libmysofa can't interpret as plain HRIR measurements.
+        std::unique_ptr<BRTSpatialiserCore::HRIRMeasurementSet> ownMeasurements;
+        if (measurements == nullptr) {
+            ownMeasurements = BRTSpatialiserCore::HRIRMeasurementSet::load(_filePath);
+            measurements = ownMeasurements.get();
+        }
+        if (measurements != nullptr) {
+            result = BRTSpatialiserCore::BuildResampledHRTF(*measurements, _resamplingStep, hrtf, progress);
+        }
+        else {
+            std::cout << "Falling back to single threaded HRTF resampling." << std::endl;
+            result = sofaReader.ReadHRTFFromSofa(_filePath, hrtf, _resamplingStep, BRTServices::TEXTRAPOLATION_METHOD::nearest_point);
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime);
         if (result) {
-            std::cout << ("HRTF Sofa file loaded successfully.") << std::endl;
+            std::cout << "HRTF Sofa file loaded successfully in " << elapsed.count() << " ms." << std::endl;
             return true;
         }
         else {
@@ -36,7 +57,7 @@ public:
         }
     }
 
-    static bool LoadBRIRSofaFile(const std::string& _filePath, std::shared_ptr<BRTServices::CHRBRIR> brir
+    static bool LoadBRIRSofaFile(const std::string& _filePath, std::shared_ptr<BRTServices::CHRBRIR> brir, int _resamplingStep
         , float _fadeWindowThreshold, float _fadeInWindowRiseTime
         , float _fadeOutWindowThreshold, float _fadeOutWindowRiseTime) {
 
@@ -54,7 +75,7 @@ public:
             return false;
         }
         std::cout << std::endl << "Loading BRIR SOFA File....." << std::endl << std::endl;
-        bool result = sofaReader.ReadBRIRFromSofa(_filePath, brir, HRTFRESAMPLINGSTEP, BRTServices::TEXTRAPOLATION_METHOD::zero_insertion, _fadeWindowThreshold, _fadeInWindowRiseTime, _fadeOutWindowThreshold, _fadeOutWindowRiseTime);
+        bool result = sofaReader.ReadBRIRFromSofa(_filePath, brir, _resamplingStep, BRTServices::TEXTRAPOLATION_METHOD::zero_insertion, _fadeWindowThreshold, _fadeInWindowRiseTime, _fadeOutWindowThreshold, _fadeOutWindowRiseTime);
         if (result) {
             std::cout << ("BRIR Sofa file loaded successfully.") << std::endl;
             return true;
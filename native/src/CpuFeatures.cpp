@@ -0,0 +1,87 @@
+#include "CpuFeatures.h"
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#if BRT_X86_DISPATCH && defined(_MSC_VER)
+ #include <intrin.h>
+ #include <immintrin.h>
+#endif
+
+namespace BRTHelpers
+{
+    namespace
+    {
+        CpuLevel DetectCpuLevel()
+        {
+#if defined(__aarch64__) || defined(_M_ARM64)
+            return CpuLevel::NEON;
+#elif BRT_X86_DISPATCH && defined(_MSC_VER)
+            int info[4];
+            __cpuid (info, 1);
+            const bool hasSSE42 = (info[2] & (1 << 20)) != 0;
+            const bool hasFMA = (info[2] & (1 << 12)) != 0;
+            const bool hasF16C = (info[2] & (1 << 29)) != 0;
+            const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+
+            // The OS has to save the wider registers for the instructions to be usable
+            const unsigned long long xcr0 = hasOSXSAVE ? _xgetbv (0) : 0;
+            const bool hasAVXState = (xcr0 & 0x6) == 0x6;
+            const bool hasAVX512State = (xcr0 & 0xe6) == 0xe6;
+
+            __cpuidex (info, 7, 0);
+            const bool hasAVX2 = (info[1] & (1 << 5)) != 0;
+            const bool hasAVX512F = (info[1] & (1 << 16)) != 0;
+
+            if (hasAVX512F && hasAVX2 && hasFMA && hasF16C && hasAVX512State)
+                return CpuLevel::AVX512;
+            if (hasAVX2 && hasFMA && hasF16C && hasAVXState)
+                return CpuLevel::AVX2;
+            return hasSSE42 ? CpuLevel::SSE42 : CpuLevel::Baseline;
+#elif BRT_X86_DISPATCH
+            // Also checks that the OS saves the AVX and AVX-512 registers
+            __builtin_cpu_init();
+            const bool hasAVX2 = __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")
+                              && __builtin_cpu_supports ("f16c");
+            if (hasAVX2 && __builtin_cpu_supports ("avx512f"))
+                return CpuLevel::AVX512;
+            if (hasAVX2)
+                return CpuLevel::AVX2;
+            return __builtin_cpu_supports ("sse4.2") ? CpuLevel::SSE42 : CpuLevel::Baseline;
+#else
+            return CpuLevel::Baseline;
+#endif
+        }
+
+        CpuLevel ApplyOverride (CpuLevel detected)
+        {
+            const char* requested = std::getenv ("BRT_CPU_LEVEL");
+            if (requested == nullptr || detected == CpuLevel::NEON)
+                return detected;
+
+            for (CpuLevel level : { CpuLevel::Baseline, CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512 })
+                if (std::strcmp (requested, GetCpuLevelName (level)) == 0)
+                    return level < detected ? level : detected;
+            return detected;
+        }
+    }
+
+    CpuLevel GetCpuLevel()
+    {
+        static const CpuLevel level = ApplyOverride (DetectCpuLevel());
+        return level;
+    }
+
+    const char* GetCpuLevelName (CpuLevel level)
+    {
+        switch (level)
+        {
+            case CpuLevel::Baseline: return "baseline";
+            case CpuLevel::SSE42:    return "sse4.2";
+            case CpuLevel::AVX2:     return "avx2";
+            case CpuLevel::AVX512:   return "avx512";
+            case CpuLevel::NEON:     return "neon";
+        }
+        return "?";
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Runtime selection of SIMD kernels, so one shipped binary uses the widest instructions each machine has.
+// Each variant of a kernel is written with the intrinsics of its instruction set and marked with BRT_TARGET,
+// and the caller picks one with GetCpuLevel. On x86 with GCC or Clang the attribute lets a variant use
+// instructions the rest of the build doesn't; MSVC compiles intrinsics for any instruction set without one,
+// but only vectorises plain loops for the set the build targets, so variants must not rely on that.
+// arm64 always has NEON, so it needs no dispatch.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+ #define BRT_X86_DISPATCH 1
+ #define BRT_TARGET(isa) __attribute__ ((target (isa)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+ #define BRT_X86_DISPATCH 1
+ #define BRT_TARGET(isa)
+#else
+ #define BRT_X86_DISPATCH 0
+ #define BRT_TARGET(isa)
+#endif
+
+// The instruction sets the variants are built for
+#define BRT_TARGET_SSE42 BRT_TARGET ("sse4.2")
+#define BRT_TARGET_AVX2 BRT_TARGET ("avx2,fma,f16c")
+#define BRT_TARGET_AVX512 BRT_TARGET ("avx512f,avx2,fma,f16c")
+
+namespace BRTHelpers
+{
+    // Ordered so a kernel can use the widest variant at or below the level
+    enum class CpuLevel : int
+    {
+        Baseline = 0,  // SSE2 on x86_64, whatever the build targets elsewhere
+        SSE42 = 1,
+        AVX2 = 2,      // With FMA and F16C
+        AVX512 = 3,    // AVX-512F
+        NEON = 4,      // arm64, chosen at compile time
+    };
+
+    // Detected on first use. The BRT_CPU_LEVEL environment variable (baseline, sse4.2, avx2 or avx512) caps it,
+    // to compare the variants on one machine.
+    CpuLevel GetCpuLevel();
+
+    const char* GetCpuLevelName (CpuLevel level);
+}
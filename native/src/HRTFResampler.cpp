@@ -0,0 +1,297 @@
+#include "HRTFResampler.h"
+#include "AudioPluginUtil.h"
+#include "ParallelFor.h"
+#include "SimdKernels.h"
+#include "libmysofa/include/mysofa.h"
+#include <cfloat>
+#include <cstdlib>
+
+namespace BRTSpatialiserCore
+{
+	// Share of the progress reported while interpolating, the rest covers the BRT setup that follows
+	const float InterpolationProgressShare = 0.8f;
+
+	std::unique_ptr<HRIRMeasurementSet> HRIRMeasurementSet::load (const std::string& path, BRTHelpers::SampleFormat format)
+	{
+		int error = MYSOFA_OK;
+		MYSOFA_HRTF* sofa = mysofa_load (path.c_str(), &error);
+		if (sofa == nullptr || error != MYSOFA_OK)
+		{
+			if (sofa != nullptr)
+				mysofa_free (sofa);
+			return nullptr;
+		}
+
+		std::unique_ptr<HRIRMeasurementSet> set (new HRIRMeasurementSet());
+		set->sofa = sofa;
+
+		if (mysofa_check (sofa) != MYSOFA_OK || sofa->R != 2 || sofa->N == 0 || sofa->M == 0)
+			return nullptr;
+
+		set->irLength = (int) sofa->N;
+		set->numMeasurements = (int) sofa->M;
+		set->sampleRate = sofa->DataSamplingRate.values[0];
+
+		// The ears are at (0, +-r, 0) relative to the listener
+		if (sofa->ReceiverPosition.elements >= 3)
+			set->headRadius = std::fabs (sofa->ReceiverPosition.values[1]);
+
+		mysofa_tocartesian (sofa);
+
+		double distanceSum = 0.0;
+		for (unsigned int m = 0; m < sofa->M; ++m)
+		{
+			const float* p = sofa->SourcePosition.values + m * 3;
+			distanceSum += std::sqrt (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+		}
+		set->distance = (float) (distanceSum / sofa->M);
+
+		set->lookup = mysofa_lookup_init (sofa);
+		if (set->lookup == nullptr)
+			return nullptr;
+
+		set->neighborhood = mysofa_neighborhood_init (sofa, set->lookup);
+		if (set->neighborhood == nullptr)
+			return nullptr;
+
+		// Take our own copy of the impulse responses in the requested format. The lookup structures only need
+		// the source positions so libmysofa's float copy is freed (it allocates with malloc).
+		const size_t numSamples = (size_t) sofa->M * 2 * sofa->N;
+		set->format = format;
+		if (format == BRTHelpers::SampleFormat::Float32)
+		{
+			set->irs.assign (sofa->DataIR.values, sofa->DataIR.values + numSamples);
+		}
+		else
+		{
+			set->packedIRs.resize (numSamples);
+			BRTHelpers::PackSamples (sofa->DataIR.values, set->packedIRs.data(), numSamples, format);
+		}
+		std::free (sofa->DataIR.values);
+		sofa->DataIR.values = nullptr;
+		sofa->DataIR.elements = 0;
+
+		// Delays are given either per measurement or once for the whole file
+		set->delays.resize ((size_t) sofa->M * 2);
+		for (unsigned int m = 0; m < sofa->M; ++m)
+		{
+			const unsigned int offset = sofa->DataDelay.elements >= sofa->M * 2 ? m * 2 : 0;
+			set->delays[m * 2] = sofa->DataDelay.elements > offset ? sofa->DataDelay.values[offset] : 0.0f;
+			set->delays[m * 2 + 1] = sofa->DataDelay.elements > offset + 1 ? sofa->DataDelay.values[offset + 1] : 0.0f;
+		}
+
+		return set;
+	}
+
+	HRIRMeasurementSet::~HRIRMeasurementSet()
+	{
+		if (neighborhood != nullptr)
+			mysofa_neighborhood_free (neighborhood);
+		if (lookup != nullptr)
+			mysofa_lookup_free (lookup);
+		if (sofa != nullptr)
+			mysofa_free (sofa);
+	}
+
+	void HRIRMeasurementSet::interpolate (float azimuth, float elevation, float* left, float* right,
+	                                      float& leftDelay, float& rightDelay, float* scratch) const
+	{
+		float coordinate[3];
+		const int nearest = findNearest (azimuth, elevation, coordinate);
+
+		// Inverse distance weighting of the nearest measurement and, along each axis of the neighbourhood, the
+		// closer of its two neighbours. This is what mysofa_interpolate does, but reading our own storage.
+		std::fill (scratch, scratch + 2 * irLength, 0.0f);
+		float weightSum = 0.0f;
+		leftDelay = 0.0f;
+		rightDelay = 0.0f;
+
+		auto add = [&] (int measurement, float weight)
+		{
+			accumulate ((size_t) measurement * 2 * irLength, (size_t) 2 * irLength, weight, scratch);
+			leftDelay += weight * delays[measurement * 2];
+			rightDelay += weight * delays[measurement * 2 + 1];
+			weightSum += weight;
+		};
+
+		const float nearestDistance = distanceTo (coordinate, nearest);
+		if (nearestDistance < 1e-5f)
+		{
+			add (nearest, 1.0f);
+		}
+		else
+		{
+			add (nearest, 1.0f / nearestDistance);
+
+			const int* neighbours = mysofa_neighborhood (neighborhood, nearest);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const int a = neighbours[axis * 2];
+				const int b = neighbours[axis * 2 + 1];
+				const float distanceA = a >= 0 ? distanceTo (coordinate, a) : FLT_MAX;
+				const float distanceB = b >= 0 ? distanceTo (coordinate, b) : FLT_MAX;
+
+				// Equidistant neighbours cancel out
+				if (distanceA == distanceB)
+					continue;
+
+				const int closer = distanceA < distanceB ? a : b;
+				add (closer, 1.0f / std::max (1e-5f, std::min (distanceA, distanceB)));
+			}
+		}
+
+		const float scale = 1.0f / weightSum;
+		for (int i = 0; i < irLength; ++i)
+		{
+			left[i] = scratch[i] * scale;
+			right[i] = scratch[irLength + i] * scale;
+		}
+		leftDelay *= scale;
+		rightDelay *= scale;
+	}
+
+	int HRIRMeasurementSet::findNearest (float azimuth, float elevation, float* coordinate) const
+	{
+		coordinate[0] = azimuth;
+		coordinate[1] = elevation;
+		coordinate[2] = distance;
+		mysofa_s2c (coordinate);
+
+		const int nearest = mysofa_lookup (lookup, coordinate);
+		assert (nearest >= 0);
+		return nearest;
+	}
+
+	size_t HRIRMeasurementSet::getStorageBytes() const
+	{
+		return irs.size() * sizeof (float) + packedIRs.size() * sizeof (uint16_t) + delays.size() * sizeof (float);
+	}
+
+	float HRIRMeasurementSet::distanceTo (const float* coordinate, int measurement) const
+	{
+		const float* p = sofa->SourcePosition.values + measurement * 3;
+		const float dx = coordinate[0] - p[0];
+		const float dy = coordinate[1] - p[1];
+		const float dz = coordinate[2] - p[2];
+		return std::sqrt (dx * dx + dy * dy + dz * dz);
+	}
+
+	void HRIRMeasurementSet::accumulate (size_t offset, size_t count, float weight, float* destination) const
+	{
+		if (format == BRTHelpers::SampleFormat::Float32)
+			BRTHelpers::AccumulateWeighted (destination, irs.data() + offset, count, weight);
+		else
+			BRTHelpers::AccumulateWeighted (destination, packedIRs.data() + offset, count, weight, format);
+	}
+
+	std::vector<GridDirection> MakeResamplingGrid (int resamplingStep)
+	{
+		const int step = std::clamp (resamplingStep, 1, 90);
+		std::vector<GridDirection> grid;
+
+		for (int elevation = -90; elevation <= 90; elevation += step)
+		{
+			if (std::abs (elevation) == 90)
+			{
+				grid.push_back ({ 0.0f, (float) elevation });
+				continue;
+			}
+
+			const double circumference = 360.0 * std::cos (elevation * kPI_double / 180.0);
+			const int numAzimuths = std::max (1, (int) std::lround (circumference / step));
+			for (int a = 0; a < numAzimuths; ++a)
+				grid.push_back ({ (float) (360.0 * a / numAzimuths), (float) elevation });
+		}
+
+		// Make sure the north pole is present when 180 isn't a multiple of the step
+		if (grid.back().elevation != 90.0f)
+			grid.push_back ({ 0.0f, 90.0f });
+
+		return grid;
+	}
+
+	size_t EstimateTableBytes (int resamplingStep, int irLength, int bufferSize)
+	{
+		if (irLength <= 0 || bufferSize <= 0)
+			return 0;
+
+		const size_t numPartitions = ((size_t) irLength + bufferSize - 1) / bufferSize;
+		const size_t floatsPerEar = (size_t) irLength + numPartitions * 2 * bufferSize;
+		return MakeResamplingGrid (resamplingStep).size() * 2 * floatsPerEar * sizeof (float);
+	}
+
+	void ApplyHRTFSettings (const HRTFSettings& settings, BRTServices::CHRTF& hrtf)
+	{
+		if (settings.headRadius.has_value())
+			hrtf.SetHeadRadius (*settings.headRadius);
+
+		if (settings.isCustomITDEnabled.has_value())
+		{
+			if (*settings.isCustomITDEnabled)
+				hrtf.EnableWoodworthITD();
+			else
+				hrtf.DisableWoodworthITD();
+		}
+	}
+
+	bool SetUpHRTF (const std::vector<GridDirection>& grid, const std::vector<float>& irs, const std::vector<float>& delays,
+	                const HRIRMeasurementSet& measurements, int resamplingStep, std::shared_ptr<BRTServices::CHRTF> hrtf)
+	{
+		const int irLength = measurements.getIRLength();
+
+		// The BRT tables are not thread safe so they are filled in grid order on this thread. Every grid
+		// direction is present so BRT's own resampling only has to copy, which tests/HRTFResamplerTest checks.
+		hrtf->BeginSetup (irLength, BRTServices::TEXTRAPOLATION_METHOD::nearest_point);
+		hrtf->SetGridSamplingStep (resamplingStep);
+		hrtf->SetHeadRadius (measurements.getHeadRadius());
+
+		for (size_t i = 0; i < grid.size(); ++i)
+		{
+			const float* ir = irs.data() + i * 2 * irLength;
+
+			BRTServices::THRIRStruct hrir;
+			hrir.leftDelay = (uint64_t) std::max (0L, std::lround (delays[2 * i]));
+			hrir.rightDelay = (uint64_t) std::max (0L, std::lround (delays[2 * i + 1]));
+			hrir.leftHRIR.assign (ir, ir + irLength);
+			hrir.rightHRIR.assign (ir + irLength, ir + 2 * irLength);
+
+			// BRT expects elevations below the horizon as 270..360
+			const float elevation = grid[i].elevation < 0.0f ? grid[i].elevation + 360.0f : grid[i].elevation;
+			hrtf->AddHRIR (grid[i].azimuth, elevation, measurements.getDistance(), std::move (hrir));
+		}
+
+		return hrtf->EndSetup();
+	}
+
+	bool BuildResampledHRTF (const HRIRMeasurementSet& measurements, int resamplingStep,
+	                         std::shared_ptr<BRTServices::CHRTF> hrtf, std::atomic<float>* progress)
+	{
+		const std::vector<GridDirection> grid = MakeResamplingGrid (resamplingStep);
+		const int numPoints = (int) grid.size();
+		const int irLength = measurements.getIRLength();
+
+		std::vector<float> irs ((size_t) numPoints * 2 * irLength);
+		std::vector<float> delays ((size_t) numPoints * 2);
+		std::atomic<int> numDone { 0 };
+
+		BRTHelpers::ParallelFor (0, numPoints, [&] (int i)
+		{
+			thread_local std::vector<float> scratch;
+			scratch.resize ((size_t) 2 * irLength);
+
+			float* ir = irs.data() + (size_t) i * 2 * irLength;
+			measurements.interpolate (grid[i].azimuth, grid[i].elevation, ir, ir + irLength,
+			                          delays[2 * i], delays[2 * i + 1], scratch.data());
+
+			if (progress != nullptr)
+				progress->store (InterpolationProgressShare * (float) ++numDone / (float) numPoints);
+		}, 16);
+
+		const bool result = SetUpHRTF (grid, irs, delays, measurements, resamplingStep, hrtf);
+
+		if (progress != nullptr)
+			progress->store (1.0f);
+
+		return result;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "BRTLibrary.h"
+#include "HalfFloat.h"
+
+struct MYSOFA_HRTF;
+struct MYSOFA_LOOKUP;
+struct MYSOFA_NEIGHBORHOOD;
+
+namespace BRTSpatialiserCore
+{
+	//==========================================================================
+	// The raw measurements of an HRTF SOFA file, read through libmysofa, together with the lookup structures
+	// needed to interpolate an HRIR in any direction. interpolate() only reads shared state, so any number of
+	// threads may call it at once as long as each passes its own scratch buffer. The impulse responses can be
+	// held in a 16 bit format, in which case they are widened as they are interpolated.
+	class HRIRMeasurementSet
+	{
+	public:
+		// Returns nullptr if the file can't be read or isn't a two receiver SimpleFreeFieldHRIR file.
+		static std::unique_ptr<HRIRMeasurementSet> load (const std::string& path,
+		                                                 BRTHelpers::SampleFormat format = BRTHelpers::SampleFormat::Float32);
+		~HRIRMeasurementSet();
+
+		int getIRLength() const             { return irLength; }
+		int getNumMeasurements() const      { return numMeasurements; }
+		float getSampleRate() const         { return sampleRate; }
+		float getDistance() const           { return distance; }
+		float getHeadRadius() const         { return headRadius; }
+		BRTHelpers::SampleFormat getFormat() const { return format; }
+		// Memory used by the impulse responses and delays
+		size_t getStorageBytes() const;
+
+		// Writes the HRIRs for a direction, in degrees using the SOFA convention, to left and right and their
+		// delays in samples to leftDelay and rightDelay. scratch must hold at least 2 * getIRLength() floats.
+		void interpolate (float azimuth, float elevation, float* left, float* right,
+		                  float& leftDelay, float& rightDelay, float* scratch) const;
+
+	private:
+		HRIRMeasurementSet() = default;
+		float distanceTo (const float* coordinate, int measurement) const;
+		int findNearest (float azimuth, float elevation, float* coordinate) const;
+		// Adds weight times count stored samples from offset onwards to destination
+		void accumulate (size_t offset, size_t count, float weight, float* destination) const;
+
+		MYSOFA_HRTF* sofa = nullptr;
+		MYSOFA_LOOKUP* lookup = nullptr;
+		MYSOFA_NEIGHBORHOOD* neighborhood = nullptr;
+		int irLength = 0;
+		int numMeasurements = 0;
+		float sampleRate = 0.0f;
+		float distance = 1.0f;
+		float headRadius = 0.0875f;
+		BRTHelpers::SampleFormat format = BRTHelpers::SampleFormat::Float32;
+		std::vector<float> irs;             // Left then right ear for each measurement, when format is Float32
+		std::vector<uint16_t> packedIRs;    // Same layout in the 16 bit formats
+		std::vector<float> delays;          // Left and right delay in samples for each measurement
+	};
+
+	// Settings BRT keeps on the CHRTF itself rather than on the listener, so tables built with different ones are
+	// never shared. Unset values leave what the SOFA file gives.
+	struct HRTFSettings
+	{
+		std::optional<float> headRadius;
+		std::optional<bool> isCustomITDEnabled;
+
+		bool operator== (const HRTFSettings& other) const { return headRadius == other.headRadius && isCustomITDEnabled == other.isCustomITDEnabled; }
+		bool operator!= (const HRTFSettings& other) const { return ! (*this == other); }
+	};
+
+	// Applies settings to an HRTF that has been set up but not yet handed to anyone
+	void ApplyHRTFSettings (const HRTFSettings& settings, BRTServices::CHRTF& hrtf);
+
+	struct GridDirection
+	{
+		float azimuth;
+		float elevation;
+	};
+
+	// The directions of a resampling grid with the given step in degrees. Rings are spaced by step in elevation
+	// and each ring has as many equally spaced azimuths as fit at that step along its circumference.
+	std::vector<GridDirection> MakeResamplingGrid (int resamplingStep);
+
+	// Approximate memory held by BRT for a table resampled at the given step. Each direction stores both ears in
+	// the time domain and, for the uniformly partitioned convolution, in the frequency domain.
+	size_t EstimateTableBytes (int resamplingStep, int irLength, int bufferSize);
+
+	// Sets hrtf up from one HRIR per direction of grid, given as left then right ear per direction in irs with the
+	// left and right delays in delays. irLength, distance and head radius are taken from measurements.
+	bool SetUpHRTF (const std::vector<GridDirection>& grid, const std::vector<float>& irs, const std::vector<float>& delays,
+	                const HRIRMeasurementSet& measurements, int resamplingStep, std::shared_ptr<BRTServices::CHRTF> hrtf);
+
+	// Interpolates the measurements on every direction of the resampling grid, spread across all cores, and
+	// sets hrtf up from the result. The output does not depend on the number of threads. Progress, if given,
+	// is advanced from 0 to 1.
+	bool BuildResampledHRTF (const HRIRMeasurementSet& measurements, int resamplingStep,
+	                         std::shared_ptr<BRTServices::CHRTF> hrtf, std::atomic<float>* progress = nullptr);
+}
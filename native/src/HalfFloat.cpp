@@ -0,0 +1,175 @@
+#include "HalfFloat.h"
+#include "CpuFeatures.h"
+
+// F16C is used unconditionally when the build targets it, and otherwise on x86 when the CPU turns out to have it
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+ #define BRT_HALF_F16C 1
+ #include <immintrin.h>
+#elif BRT_X86_DISPATCH
+ #define BRT_HALF_F16C_DISPATCH 1
+ #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #define BRT_HALF_NEON 1
+ #include <arm_neon.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+ #define BRT_HALF_SSE2 1
+ #include <emmintrin.h>
+#endif
+
+namespace BRTHelpers
+{
+    namespace
+    {
+#if BRT_HALF_F16C || BRT_HALF_F16C_DISPATCH
+        // The F16C conversions come with AVX2 on every CPU that has them, so they are picked by the AVX2 level.
+        // Each returns how many samples it handled, a multiple of eight.
+        BRT_TARGET_AVX2 size_t PackHalfF16C (const float* source, uint16_t* destination, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+                _mm_storeu_si128 ((__m128i*) (destination + i), _mm256_cvtps_ph (_mm256_loadu_ps (source + i), _MM_FROUND_TO_NEAREST_INT));
+            return i;
+        }
+
+        BRT_TARGET_AVX2 size_t AccumulateHalfF16C (float* destination, const uint16_t* source, size_t count, float weight)
+        {
+            size_t i = 0;
+            const __m256 w = _mm256_set1_ps (weight);
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 widened = _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i*) (source + i)));
+                _mm256_storeu_ps (destination + i, _mm256_add_ps (_mm256_loadu_ps (destination + i), _mm256_mul_ps (widened, w)));
+            }
+            return i;
+        }
+#endif
+
+#if BRT_HALF_F16C_DISPATCH
+        bool HasF16C()
+        {
+            return GetCpuLevel() >= CpuLevel::AVX2;
+        }
+#endif
+
+#if BRT_HALF_SSE2 && !BRT_HALF_F16C
+        size_t AccumulateHalfSSE2 (float* destination, const uint16_t* source, size_t count, float weight)
+        {
+            size_t i = 0;
+            // Without F16C: the same bit manipulation as HalfToFloat, four lanes at a time. Half subnormals are
+            // rebuilt with a subtraction of normal floats so the slow float denormal path is never hit.
+            const __m128 w = _mm_set1_ps (weight);
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i noSign = _mm_set1_epi32 (0x7fff);
+            const __m128i exponentMask = _mm_set1_epi32 (0x7c00 << 13);
+            const __m128i rebias = _mm_set1_epi32 ((127 - 15) << 23);
+            const __m128i oneExponent = _mm_set1_epi32 (1 << 23);
+            const __m128 subnormalOffset = _mm_set1_ps (6.103515625e-05f); // 2^-14
+
+            auto widen = [&] (__m128i half)
+            {
+                const __m128i magnitude = _mm_and_si128 (half, noSign);
+                const __m128i sign = _mm_slli_epi32 (_mm_xor_si128 (half, magnitude), 16);
+                const __m128i shifted = _mm_slli_epi32 (magnitude, 13);
+                const __m128i exponent = _mm_and_si128 (shifted, exponentMask);
+
+                const __m128i isInfNaN = _mm_cmpeq_epi32 (exponent, exponentMask);
+                const __m128i isSubnormal = _mm_cmpeq_epi32 (exponent, zero);
+                const __m128i normal = _mm_add_epi32 (_mm_add_epi32 (shifted, rebias), _mm_and_si128 (isInfNaN, rebias));
+                const __m128i subnormal = _mm_castps_si128 (_mm_sub_ps (_mm_castsi128_ps (_mm_add_epi32 (normal, oneExponent)), subnormalOffset));
+
+                const __m128i bits = _mm_or_si128 (_mm_and_si128 (isSubnormal, subnormal), _mm_andnot_si128 (isSubnormal, normal));
+                return _mm_castsi128_ps (_mm_or_si128 (bits, sign));
+            };
+
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i packed = _mm_loadu_si128 ((const __m128i*) (source + i));
+                const __m128 low = widen (_mm_unpacklo_epi16 (packed, zero));
+                const __m128 high = widen (_mm_unpackhi_epi16 (packed, zero));
+                _mm_storeu_ps (destination + i, _mm_add_ps (_mm_loadu_ps (destination + i), _mm_mul_ps (low, w)));
+                _mm_storeu_ps (destination + i + 4, _mm_add_ps (_mm_loadu_ps (destination + i + 4), _mm_mul_ps (high, w)));
+            }
+            return i;
+        }
+#endif
+    }
+
+    void PackSamples (const float* source, uint16_t* destination, size_t count, SampleFormat format)
+    {
+        size_t i = 0;
+
+        if (format == SampleFormat::Float16)
+        {
+#if BRT_HALF_F16C
+            i = PackHalfF16C (source, destination, count);
+#elif BRT_HALF_F16C_DISPATCH
+            if (HasF16C())
+                i = PackHalfF16C (source, destination, count);
+#elif BRT_HALF_NEON
+            for (; i + 4 <= count; i += 4)
+                vst1_u16 (destination + i, vreinterpret_u16_f16 (vcvt_f16_f32 (vld1q_f32 (source + i))));
+#endif
+            for (; i < count; ++i)
+                destination[i] = FloatToHalf (source[i]);
+        }
+        else if (format == SampleFormat::BFloat16)
+        {
+            for (; i < count; ++i)
+                destination[i] = FloatToBFloat16 (source[i]);
+        }
+    }
+
+    void AccumulateWeighted (float* destination, const uint16_t* source, size_t count, float weight, SampleFormat format)
+    {
+        size_t i = 0;
+
+        if (format == SampleFormat::Float16)
+        {
+#if BRT_HALF_F16C
+            i = AccumulateHalfF16C (destination, source, count, weight);
+#elif BRT_HALF_F16C_DISPATCH && BRT_HALF_SSE2
+            i = HasF16C() ? AccumulateHalfF16C (destination, source, count, weight)
+                          : AccumulateHalfSSE2 (destination, source, count, weight);
+#elif BRT_HALF_F16C_DISPATCH
+            if (HasF16C())
+                i = AccumulateHalfF16C (destination, source, count, weight);
+#elif BRT_HALF_SSE2
+            i = AccumulateHalfSSE2 (destination, source, count, weight);
+#elif BRT_HALF_NEON
+            for (; i + 4 <= count; i += 4)
+            {
+                const float32x4_t widened = vcvt_f32_f16 (vreinterpret_f16_u16 (vld1_u16 (source + i)));
+                vst1q_f32 (destination + i, vmlaq_n_f32 (vld1q_f32 (destination + i), widened, weight));
+            }
+#endif
+            for (; i < count; ++i)
+                destination[i] += weight * HalfToFloat (source[i]);
+        }
+        else if (format == SampleFormat::BFloat16)
+        {
+            // Widening is just a shift into the top half of each 32 bit lane
+#if BRT_HALF_SSE2
+            const __m128 w = _mm_set1_ps (weight);
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i packed = _mm_loadu_si128 ((const __m128i*) (source + i));
+                const __m128 low = _mm_castsi128_ps (_mm_unpacklo_epi16 (zero, packed));
+                const __m128 high = _mm_castsi128_ps (_mm_unpackhi_epi16 (zero, packed));
+                _mm_storeu_ps (destination + i, _mm_add_ps (_mm_loadu_ps (destination + i), _mm_mul_ps (low, w)));
+                _mm_storeu_ps (destination + i + 4, _mm_add_ps (_mm_loadu_ps (destination + i + 4), _mm_mul_ps (high, w)));
+            }
+#elif BRT_HALF_NEON
+            for (; i + 4 <= count; i += 4)
+            {
+                const float32x4_t widened = vreinterpretq_f32_u32 (vshll_n_u16 (vld1_u16 (source + i), 16));
+                vst1q_f32 (destination + i, vmlaq_n_f32 (vld1q_f32 (destination + i), widened, weight));
+            }
+#endif
+            for (; i < count; ++i)
+                destination[i] += weight * BFloat16ToFloat (source[i]);
+        }
+    }
+}
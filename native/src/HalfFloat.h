@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace BRTHelpers
+{
+    // How raw impulse responses are held while a table is interpolated from them. The 16 bit formats halve that
+    // temporary copy and are widened to float as they are read. Must be kept in sync with the HRIRStorageFormat enum in c# code.
+    enum class SampleFormat : int
+    {
+        Float32 = 0,
+        Float16 = 1,   // IEEE 754 half: 11 bit precision, about 66 dB SNR for full scale signals
+        BFloat16 = 2,  // float with the mantissa cut to 8 bits: same range as float, about 48 dB SNR
+    };
+
+    // Round to nearest even, overflowing to infinity
+    inline uint16_t FloatToHalf (float value)
+    {
+        uint32_t bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t magnitude = bits & 0x7fffffffu;
+
+        if (magnitude >= 0x47800000u) // Inf, NaN or too large
+            return (uint16_t) (sign | (magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u));
+
+        if (magnitude < 0x38800000u) // Subnormal in half: let the FPU do the rounding by adding 0.5
+        {
+            float f;
+            std::memcpy (&f, &magnitude, sizeof (f));
+            f += 0.5f;
+            std::memcpy (&magnitude, &f, sizeof (f));
+            return (uint16_t) (sign | (magnitude - 0x3f000000u));
+        }
+
+        const uint32_t mantissaOdd = (magnitude >> 13) & 1u;
+        magnitude += 0xc8000fffu + mantissaOdd; // Rebias the exponent and round
+        return (uint16_t) (sign | (magnitude >> 13));
+    }
+
+    inline float HalfToFloat (uint16_t half)
+    {
+        const uint32_t shiftedExponent = 0x7c00u << 13;
+        uint32_t bits = (uint32_t) (half & 0x7fffu) << 13;
+        const uint32_t exponent = bits & shiftedExponent;
+        bits += (127u - 15u) << 23;
+
+        float value;
+        if (exponent == shiftedExponent) // Inf or NaN
+        {
+            bits += (128u - 16u) << 23;
+            std::memcpy (&value, &bits, sizeof (value));
+        }
+        else if (exponent == 0) // Zero or subnormal
+        {
+            bits += 1u << 23;
+            std::memcpy (&value, &bits, sizeof (value));
+            value -= 6.103515625e-05f; // 2^-14
+        }
+        else
+        {
+            std::memcpy (&value, &bits, sizeof (value));
+        }
+        return (half & 0x8000u) ? -value : value;
+    }
+
+    // Round to nearest even
+    inline uint16_t FloatToBFloat16 (float value)
+    {
+        uint32_t bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+
+        if ((bits & 0x7fffffffu) > 0x7f800000u) // Keep NaNs quiet rather than rounding them to infinity
+            return (uint16_t) ((bits >> 16) | 0x40u);
+
+        bits += 0x7fffu + ((bits >> 16) & 1u);
+        return (uint16_t) (bits >> 16);
+    }
+
+    inline float BFloat16ToFloat (uint16_t bfloat)
+    {
+        const uint32_t bits = (uint32_t) bfloat << 16;
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    // Converts count floats to one of the 16 bit formats
+    void PackSamples (const float* source, uint16_t* destination, size_t count, SampleFormat format);
+
+    // destination[i] += weight * source[i], widening source from a 16 bit format. This is the inner loop of
+    // everything that reads a packed table so it uses F16C or NEON where the build allows.
+    void AccumulateWeighted (float* destination, const uint16_t* source, size_t count, float weight, SampleFormat format);
+}
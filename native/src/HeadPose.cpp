@@ -0,0 +1,123 @@
+#include "HeadPose.h"
+#include <chrono>
+#include <cmath>
+
+namespace BRTSpatialiserCore
+{
+	namespace
+	{
+		// Reads overlapping a write before the audio thread gives up for this block
+		constexpr int MaxReadAttempts = 4;
+	}
+
+	double HeadPoseClock()
+	{
+		return std::chrono::duration<double> (std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	Common::CTransform ExtrapolateHeadPose (const HeadPose& pose, float dt, float scaleFactor)
+	{
+		float w = pose.rotationW, x = pose.rotationX, y = pose.rotationY, z = pose.rotationZ;
+
+		// The angular velocity is about world axes, so the step is applied before the current rotation
+		const float speed = std::sqrt (pose.angularVelocityX * pose.angularVelocityX + pose.angularVelocityY * pose.angularVelocityY
+		                               + pose.angularVelocityZ * pose.angularVelocityZ);
+		const float halfAngle = 0.5f * speed * dt;
+		if (halfAngle > 1e-6f)
+		{
+			const float s = std::sin (halfAngle) / speed;
+			const float dw = std::cos (halfAngle);
+			const float dx = pose.angularVelocityX * s;
+			const float dy = pose.angularVelocityY * s;
+			const float dz = pose.angularVelocityZ * s;
+
+			const float rw = dw * w - dx * x - dy * y - dz * z;
+			const float rx = dw * x + dx * w + dy * z - dz * y;
+			const float ry = dw * y - dx * z + dy * w + dz * x;
+			const float rz = dw * z + dx * y - dy * x + dz * w;
+			const float norm = std::sqrt (rw * rw + rx * rx + ry * ry + rz * rz);
+			w = rw / norm;
+			x = rx / norm;
+			y = ry / norm;
+			z = rz / norm;
+		}
+
+		Common::CTransform transform;
+		transform.SetPosition (Common::CVector3 (pose.positionX * scaleFactor, pose.positionY * scaleFactor, pose.positionZ * scaleFactor));
+		transform.SetOrientation (Common::CQuaternion (w, x, y, z));
+		return transform;
+	}
+
+	HeadPoseSlot& HeadPoseSlot::instance()
+	{
+		static HeadPoseSlot slot;
+		return slot;
+	}
+
+	HeadPoseSlot::HeadPoseSlot()
+	{
+		for (auto& field : fields)
+			field.store (0.0f, std::memory_order_relaxed);
+	}
+
+	void HeadPoseSlot::write (const HeadPose& pose)
+	{
+		const float values[NumFields] = { pose.positionX, pose.positionY, pose.positionZ,
+		                                  pose.rotationW, pose.rotationX, pose.rotationY, pose.rotationZ,
+		                                  pose.angularVelocityX, pose.angularVelocityY, pose.angularVelocityZ };
+
+		const UInt32 s = sequence.load (std::memory_order_relaxed);
+		sequence.store (s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence (std::memory_order_release);
+
+		timestamp.store (pose.timestamp, std::memory_order_relaxed);
+		for (int f = 0; f < NumFields; ++f)
+			fields[f].store (values[f], std::memory_order_relaxed);
+		hasPose.store (true, std::memory_order_relaxed);
+
+		sequence.store (s + 2, std::memory_order_release);
+	}
+
+	void HeadPoseSlot::clear()
+	{
+		hasPose.store (false, std::memory_order_release);
+	}
+
+	bool HeadPoseSlot::read (HeadPose& pose, bool& isConsistent) const
+	{
+		float values[NumFields];
+		for (int attempt = 0; attempt < MaxReadAttempts; ++attempt)
+		{
+			const UInt32 before = sequence.load (std::memory_order_acquire);
+			if (! hasPose.load (std::memory_order_relaxed))
+			{
+				isConsistent = true;
+				return false;
+			}
+			pose.timestamp = timestamp.load (std::memory_order_relaxed);
+			for (int f = 0; f < NumFields; ++f)
+				values[f] = fields[f].load (std::memory_order_relaxed);
+			std::atomic_thread_fence (std::memory_order_acquire);
+			const UInt32 after = sequence.load (std::memory_order_relaxed);
+
+			if (before == after && (before & 1) == 0)
+			{
+				pose.positionX = values[0];
+				pose.positionY = values[1];
+				pose.positionZ = values[2];
+				pose.rotationW = values[3];
+				pose.rotationX = values[4];
+				pose.rotationY = values[5];
+				pose.rotationZ = values[6];
+				pose.angularVelocityX = values[7];
+				pose.angularVelocityY = values[8];
+				pose.angularVelocityZ = values[9];
+				isConsistent = true;
+				return true;
+			}
+		}
+
+		isConsistent = false;
+		return false;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include "AudioPluginUtil.h"
+#include "BRTLibrary.h"
+
+namespace BRTSpatialiserCore
+{
+	// A tracked head pose as reported by the XR runtime. Layout must be kept in sync with the HeadPose struct
+	// in c# code.
+	struct HeadPose
+	{
+		double timestamp;       // Seconds on HeadPoseClock when the pose was sampled
+		float positionX;        // World position in Unity units, before the scale factor
+		float positionY;
+		float positionZ;
+		float rotationW;        // World rotation as given by a Unity Quaternion
+		float rotationX;
+		float rotationY;
+		float rotationZ;
+		float angularVelocityX; // Radians per second about the world axes
+		float angularVelocityY;
+		float angularVelocityZ;
+	};
+
+	// Seconds on a steady clock shared by the plugin and the code reporting head poses
+	double HeadPoseClock();
+
+	// Listener transform for the pose rotated on by its angular velocity for dt seconds. The position is held,
+	// as trackers don't report a velocity precise enough to be worth extrapolating over a few milliseconds.
+	Common::CTransform ExtrapolateHeadPose (const HeadPose& pose, float dt, float scaleFactor);
+
+	//==========================================================================
+	// Hands the latest head pose from the XR tracking callback to the audio thread. The writer publishes under
+	// a sequence counter and never waits. The audio thread must not wait either, so a read that overlaps a
+	// write gives up after a few attempts and the caller keeps the pose it already has.
+	//
+	// Like SceneSnapshot the slot is process wide so it can be written without taking SpatialiserCore::mutex.
+	class HeadPoseSlot
+	{
+	public:
+		static HeadPoseSlot& instance();
+
+		// Only one thread may write at a time
+		void write (const HeadPose& pose);
+		// Stops the audio thread using head poses until the next write
+		void clear();
+
+		// Returns false if no pose has been written since the last clear, or if every attempt overlapped a write
+		// (isConsistent is then false too).
+		bool read (HeadPose& pose, bool& isConsistent) const;
+
+	private:
+		HeadPoseSlot();
+
+		static constexpr int NumFields = 10;
+
+		// Odd while a pose is being written
+		std::atomic<UInt32> sequence { 0 };
+		std::atomic<bool> hasPose { false };
+		std::atomic<double> timestamp { 0.0 };
+		std::array<std::atomic<float>, NumFields> fields;
+	};
+}
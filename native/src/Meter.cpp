@@ -0,0 +1,143 @@
+#include "Meter.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace BRTSpatialiserCore
+{
+	namespace
+	{
+		// Spectrum peaks fall by this much every block
+		constexpr float SpectrumDecay = 0.9f;
+	}
+
+	Meter::Meter()
+	{
+		analyzer.spectrumSize = FFTSize;
+		for (auto& level : levels)
+			level.store (0.0f, std::memory_order_relaxed);
+		for (auto& bin : spectrum)
+			bin.store (0.0f, std::memory_order_relaxed);
+	}
+
+	Meter::~Meter()
+	{
+		analyzer.Cleanup();
+	}
+
+	void Meter::process (const float* samples, int numChannels, int numFrames)
+	{
+		assert (numChannels >= 1 && numChannels <= MaxChannels);
+
+		std::array<float, BRTHelpers::LevelLanes> peaks {};
+		std::array<float, BRTHelpers::LevelLanes> sums {};
+		BRTHelpers::MeasureLanes (samples, (size_t) numChannels * numFrames, peaks.data(), sums.data());
+
+		MeterLevels result {};
+		for (int l = 0; l < BRTHelpers::LevelLanes; ++l)
+		{
+			const int channel = l % numChannels;
+			result.peak[channel] = std::max (result.peak[channel], peaks[l]);
+			result.rms[channel] += sums[l];
+		}
+		for (int c = 0; c < numChannels; ++c)
+			result.rms[c] = numFrames > 0 ? std::sqrt (result.rms[c] / numFrames) : 0.0f;
+		if (numChannels == 1)
+		{
+			result.peak[1] = result.peak[0];
+			result.rms[1] = result.rms[0];
+		}
+
+		const bool hasSpectrum = isSpectrumRequested.load (std::memory_order_relaxed);
+		if (hasSpectrum)
+			measureSpectrum (samples, numChannels, numFrames);
+
+		const UInt32 s = sequence.load (std::memory_order_relaxed);
+		sequence.store (s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence (std::memory_order_release);
+
+		for (int c = 0; c < MaxChannels; ++c)
+		{
+			levels[c].store (result.peak[c], std::memory_order_relaxed);
+			levels[MaxChannels + c].store (result.rms[c], std::memory_order_relaxed);
+		}
+		if (hasSpectrum)
+		{
+			for (int b = 0; b < SpectrumBins; ++b)
+				spectrum[b].store (spectrumScratch[b], std::memory_order_relaxed);
+		}
+
+		sequence.store (s + 2, std::memory_order_release);
+	}
+
+	void Meter::measureSpectrum (const float* samples, int numChannels, int numFrames)
+	{
+		// FFTAnalyzer shifts in at most one FFT worth of new samples, so only the end of a long block is analysed
+		const int first = std::max (0, numFrames - FFTSize);
+		const int count = numFrames - first;
+		for (int i = 0; i < count; ++i)
+		{
+			const float* frame = samples + (size_t) (first + i) * numChannels;
+			monoSamples[i] = numChannels == 1 ? frame[0] : 0.5f * (frame[0] + frame[1]);
+		}
+
+		// Allocates the FFT buffers on the first block after the spectrum is requested
+		analyzer.AnalyzeOutput (monoSamples.data(), 1, count, SpectrumDecay);
+		analyzer.ReadBuffer (spectrumScratch.data(), SpectrumBins, false);
+	}
+
+	void Meter::reset()
+	{
+		isSpectrumRequested.store (false, std::memory_order_relaxed);
+
+		const UInt32 s = sequence.load (std::memory_order_relaxed);
+		sequence.store (s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence (std::memory_order_release);
+
+		for (auto& level : levels)
+			level.store (0.0f, std::memory_order_relaxed);
+		for (auto& bin : spectrum)
+			bin.store (0.0f, std::memory_order_relaxed);
+
+		sequence.store (s + 2, std::memory_order_release);
+	}
+
+	MeterLevels Meter::readLevels() const
+	{
+		MeterLevels result;
+		UInt32 before, after;
+		do
+		{
+			before = sequence.load (std::memory_order_acquire);
+			for (int c = 0; c < MaxChannels; ++c)
+			{
+				result.peak[c] = levels[c].load (std::memory_order_relaxed);
+				result.rms[c] = levels[MaxChannels + c].load (std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence (std::memory_order_acquire);
+			after = sequence.load (std::memory_order_relaxed);
+		}
+		while (before != after || (before & 1) != 0);
+
+		return result;
+	}
+
+	void Meter::readSpectrum (float* destination, int numBins)
+	{
+		isSpectrumRequested.store (true, std::memory_order_relaxed);
+
+		const int count = std::min (numBins, (int) SpectrumBins);
+		UInt32 before, after;
+		do
+		{
+			before = sequence.load (std::memory_order_acquire);
+			for (int b = 0; b < count; ++b)
+				destination[b] = spectrum[b].load (std::memory_order_relaxed);
+			std::atomic_thread_fence (std::memory_order_acquire);
+			after = sequence.load (std::memory_order_relaxed);
+		}
+		while (before != after || (before & 1) != 0);
+
+		std::fill (destination + count, destination + std::max (count, numBins), 0.0f);
+	}
+}
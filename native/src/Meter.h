@@ -0,0 +1,86 @@
+#pragma once
+
+#include "AudioPluginUtil.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+namespace BRTSpatialiserCore
+{
+	// Levels of one block. Mono input is reported in both channels.
+	struct MeterLevels
+	{
+		float peak[2];
+		float rms[2];
+	};
+
+	//==========================================================================
+	// Peak, RMS and, once it has been asked for, the spectrum of the blocks an effect processes. The audio
+	// thread measures each block with a fixed amount of work and publishes the result under a sequence counter,
+	// so readers on any thread never take a lock or run DSP themselves, and the writer never waits for them.
+	// A reader that overlaps a publish simply reads again.
+	//
+	// Only one thread may call process and reset at a time.
+	class Meter
+	{
+	public:
+		static constexpr int MaxChannels = 2;
+		static constexpr int FFTSize = 512;
+		static constexpr int SpectrumBins = 128;  // Published spectrum, resampled from the FFTSize / 2 FFT bins
+
+		Meter();
+		~Meter();
+
+		Meter (const Meter&) = delete;
+		Meter& operator= (const Meter&) = delete;
+
+		// Audio thread. samples holds numFrames frames of numChannels (1 or 2) interleaved channels.
+		void process (const float* samples, int numChannels, int numFrames);
+		// Publishes silence and stops the spectrum analysis until it is read again
+		void reset();
+
+		// Any thread
+		MeterLevels readLevels() const;
+		// Copies up to numBins of the spectrum magnitudes and zeroes the rest. The first call turns the
+		// analysis on, so until then the audio thread doesn't run the FFT.
+		void readSpectrum (float* destination, int numBins);
+
+	private:
+		void measureSpectrum (const float* samples, int numChannels, int numFrames);
+
+		FFTAnalyzer analyzer {};  // Only touched by the audio thread
+		std::array<float, FFTSize> monoSamples;
+		std::array<float, SpectrumBins> spectrumScratch;
+		std::atomic<bool> isSpectrumRequested { false };
+
+		// Odd while the audio thread is publishing
+		std::atomic<UInt32> sequence { 0 };
+		std::array<std::atomic<float>, 2 * MaxChannels> levels;
+		std::array<std::atomic<float>, SpectrumBins> spectrum;
+	};
+
+	// Serves a meter through an effect's GetFloatBufferCallback. "Level" is peak left, peak right, RMS left
+	// and RMS right; "Spectrum" is the spectrum magnitudes from low to high frequency. Returns false for
+	// any other name.
+	inline bool ReadMeter (Meter& meter, const char* name, float* buffer, int numsamples)
+	{
+		if (std::strcmp (name, "Level") == 0)
+		{
+			const MeterLevels levels = meter.readLevels();
+			const float values[] = { levels.peak[0], levels.peak[1], levels.rms[0], levels.rms[1] };
+			const int count = std::min (numsamples, 4);
+			std::copy (values, values + count, buffer);
+			std::fill (buffer + count, buffer + numsamples, 0.0f);
+			return true;
+		}
+
+		if (std::strcmp (name, "Spectrum") == 0)
+		{
+			meter.readSpectrum (buffer, numsamples);
+			return true;
+		}
+
+		return false;
+	}
+}
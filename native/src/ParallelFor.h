@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace BRTHelpers
+{
+    // Calls body (i) for every i in [begin, end) using all hardware threads, returning when all calls are done.
+    // Indices are handed out in chunks of grainSize from a shared counter, so the distribution across threads
+    // varies between runs. Results are deterministic as long as body (i) only writes data owned by index i.
+    // Meant for load-time preprocessing: it spawns threads on every call so never use it on the audio thread.
+    template <typename Body>
+    void ParallelFor (int begin, int end, Body&& body, int grainSize = 1)
+    {
+        const int count = end - begin;
+        if (count <= 0)
+            return;
+
+        grainSize = std::max (1, grainSize);
+        const int numChunks = (count + grainSize - 1) / grainSize;
+        const int numThreads = std::min<int> (numChunks, std::max (1u, std::thread::hardware_concurrency()));
+
+        std::atomic<int> nextChunk { 0 };
+        auto worker = [&]
+        {
+            for (int chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+            {
+                const int chunkEnd = std::min (end, begin + (chunk + 1) * grainSize);
+                for (int i = begin + chunk * grainSize; i < chunkEnd; ++i)
+                    body (i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve (numThreads - 1);
+        for (int t = 1; t < numThreads; ++t)
+            threads.emplace_back (worker);
+
+        // The calling thread takes a share of the work too
+        worker();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+}
@@ -0,0 +1,70 @@
+#include "PerformanceMonitor.h"
+#include <algorithm>
+
+namespace BRTSpatialiserCore
+{
+	void PerformanceMonitor::endBlock()
+	{
+		BlockRecord& record = window[nextRecord];
+		record.total = 0.0f;
+		for (int s = 0; s < NumPerformanceStages; ++s)
+		{
+			record.stages[s] = std::chrono::duration<float, std::milli> (currentBlock[s]).count();
+			record.total += record.stages[s];
+			currentBlock[s] = {};
+		}
+
+		if (deadline > 0.0f && record.total > deadline)
+			++totalOverruns;
+
+		nextRecord = (nextRecord + 1) % WindowSize;
+		numRecorded = std::min (numRecorded + 1, WindowSize);
+	}
+
+	EngineStats PerformanceMonitor::getStats (UInt32 activeSources, UInt32 idleSources) const
+	{
+		EngineStats stats {};
+		stats.deadline = deadline;
+		stats.activeSources = activeSources;
+		stats.idleSources = idleSources;
+		stats.numBlocks = (UInt32) numRecorded;
+		stats.totalOverruns = totalOverruns;
+
+		if (numRecorded == 0)
+			return stats;
+
+		std::array<float, WindowSize> totals;
+		std::array<double, NumPerformanceStages> stageSums {};
+		double sum = 0.0;
+		for (size_t i = 0; i < numRecorded; ++i)
+		{
+			const BlockRecord& record = window[i];
+			totals[i] = record.total;
+			sum += record.total;
+			for (int s = 0; s < NumPerformanceStages; ++s)
+				stageSums[s] += record.stages[s];
+			if (deadline > 0.0f && record.total > deadline)
+				++stats.windowOverruns;
+		}
+
+		const auto end = totals.begin() + numRecorded;
+		const size_t p99Index = (numRecorded * 99) / 100;
+		std::nth_element (totals.begin(), totals.begin() + p99Index, end);
+		stats.blockTimeP99 = totals[p99Index];
+		stats.blockTimeMin = *std::min_element (totals.begin(), end);
+		stats.blockTimeMax = *std::max_element (totals.begin(), end);
+		stats.blockTimeMean = (float) (sum / numRecorded);
+		for (int s = 0; s < NumPerformanceStages; ++s)
+			stats.stageTimeMean[s] = (float) (stageSums[s] / numRecorded);
+		stats.load = deadline > 0.0f ? stats.blockTimeMean / deadline : 0.0f;
+		return stats;
+	}
+
+	size_t PerformanceMonitor::getBlockTimes (float* destination, size_t maxBlocks) const
+	{
+		const size_t count = std::min (maxBlocks, numRecorded);
+		for (size_t i = 0; i < count; ++i)
+			destination[i] = window[(nextRecord + WindowSize - count + i) % WindowSize].total;
+		return count;
+	}
+}
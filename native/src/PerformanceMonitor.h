@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AudioPluginUtil.h"
+#include <array>
+#include <chrono>
+
+namespace BRTSpatialiserCore
+{
+	// The parts of a block timed separately. BRT renders every listener model in one ProcessAll call, so its
+	// HRTF, near field and BRIR stages can only be measured together as StageRender.
+	enum PerformanceStage : int
+	{
+		StageSourceInput = 0,  // Spatialiser callbacks: decoding transforms, downmixing and feeding the sources
+		StageResources = 1,    // Installing loaded tables and applying the scene snapshot
+		StageRender = 2,       // BRT ProcessAll
+		StageOutput = 3,       // Reading and mixing the listener outputs
+		NumPerformanceStages = 4,
+	};
+
+	// Summary of the last WindowSize blocks. Times are in milliseconds. Layout must be kept in sync with the
+	// EngineStats struct in c# code, and every field is 4 bytes so it can also be read as an array of floats
+	// through GetFloatBufferCallback, with the counts converted to float.
+	struct EngineStats
+	{
+		float deadline;         // Duration of one block of audio
+		float blockTimeMin;
+		float blockTimeMean;
+		float blockTimeP99;
+		float blockTimeMax;
+		float stageTimeMean[NumPerformanceStages];
+		float load;             // blockTimeMean / deadline
+		UInt32 activeSources;
+		UInt32 idleSources;
+		UInt32 numBlocks;       // Blocks in the window
+		UInt32 windowOverruns;  // Blocks in the window that took longer than the deadline
+		UInt32 totalOverruns;   // Since the core was created
+	};
+
+	//==========================================================================
+	// Always-on timing of the audio callbacks. Stage times are accumulated as the callbacks of a block run and
+	// the manager closes the block, which records it in a fixed ring. Recording is a handful of clock reads
+	// and stores per block; the statistics are only computed when read. Every method must be called with
+	// SpatialiserCore::mutex locked.
+	class PerformanceMonitor
+	{
+	public:
+		static constexpr size_t WindowSize = 512;
+
+		void setDeadline (double seconds) { deadline = (float) (seconds * 1000.0); }
+		float getDeadline() const { return deadline; }
+		void addStageTime (PerformanceStage stage, std::chrono::steady_clock::duration time) { currentBlock[stage] += time; }
+		// Called by the manager at the end of every block
+		void endBlock();
+
+		// Milliseconds taken by the block last closed by endBlock
+		float getLastBlockTime() const { return numRecorded > 0 ? window[(nextRecord + WindowSize - 1) % WindowSize].total : 0.0f; }
+		EngineStats getStats (UInt32 activeSources, UInt32 idleSources) const;
+		// Copies up to maxBlocks of the most recent block times in milliseconds, oldest first. Returns the number copied.
+		size_t getBlockTimes (float* destination, size_t maxBlocks) const;
+
+	private:
+		struct BlockRecord
+		{
+			float total = 0.0f;
+			std::array<float, NumPerformanceStages> stages {};
+		};
+
+		float deadline = 0.0f;
+		std::array<std::chrono::steady_clock::duration, NumPerformanceStages> currentBlock {};
+		std::array<BlockRecord, WindowSize> window;
+		size_t numRecorded = 0;
+		size_t nextRecord = 0;
+		UInt32 totalOverruns = 0;
+	};
+
+	// Adds the time until it goes out of scope to a stage
+	class ScopedStageTimer
+	{
+	public:
+		ScopedStageTimer (PerformanceMonitor& m, PerformanceStage s)
+		  : monitor (m), stage (s), start (std::chrono::steady_clock::now()) {}
+		~ScopedStageTimer() { monitor.addStageTime (stage, std::chrono::steady_clock::now() - start); }
+
+	private:
+		PerformanceMonitor& monitor;
+		PerformanceStage stage;
+		std::chrono::steady_clock::time_point start;
+	};
+}
@@ -1,2 +1,3 @@
 DECLARE_EFFECT("BRT Binaural Spatialiser", BRTBinauralSpatialiser)
 DECLARE_EFFECT("BRT Manager", BRTManager)
+DECLARE_EFFECT("BRT Listener Output", BRTListenerOutput)
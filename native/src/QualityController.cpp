@@ -0,0 +1,75 @@
+#include "QualityController.h"
+#include <algorithm>
+
+namespace BRTSpatialiserCore
+{
+	namespace
+	{
+		// Weight of the newest block in the smoothed load, about a 16 block time constant
+		constexpr float LoadSmoothing = 1.0f / 16.0f;
+		// Blocks a step is given to take effect before the next step down
+		constexpr UInt32 DegradeHoldBlocks = 32;
+		// Overruns since the last step that force a step down even if the average load is fine
+		constexpr UInt32 DegradeOverruns = 2;
+	}
+
+	bool QualityController::update (float blockTime, float deadline)
+	{
+		++blockCount;
+
+		if (! settings.isEnabled || deadline <= 0.0f)
+		{
+			smoothedLoad = 0.0f;
+			return setLevel (QualityFull);
+		}
+
+		const float load = blockTime / deadline;
+		smoothedLoad += LoadSmoothing * (load - smoothedLoad);
+		++blocksSinceChange;
+		if (load > 1.0f)
+			++overrunsSinceChange;
+
+		const QualityLevel maxLevel = (QualityLevel) std::clamp (settings.maxLevel, (int) QualityFull, (int) QualityEconomy);
+		if (level > maxLevel)
+			return setLevel (maxLevel);
+
+		const bool isOverBudget = smoothedLoad > settings.degradeLoad || overrunsSinceChange >= DegradeOverruns;
+		if (isOverBudget && level < maxLevel && blocksSinceChange >= DegradeHoldBlocks)
+		{
+			++numDegrades;
+			return setLevel ((QualityLevel) (level + 1));
+		}
+
+		blocksUnderRestoreLoad = smoothedLoad < settings.restoreLoad ? blocksUnderRestoreLoad + 1 : 0;
+		const float restoreBlocks = settings.restoreTime * 1000.0f / deadline;
+		if (level > QualityFull && (float) blocksUnderRestoreLoad >= restoreBlocks)
+		{
+			++numRestores;
+			return setLevel ((QualityLevel) (level - 1));
+		}
+
+		return false;
+	}
+
+	bool QualityController::setLevel (QualityLevel newLevel)
+	{
+		if (newLevel == level)
+			return false;
+
+		level = newLevel;
+		blocksSinceChange = 0;
+		overrunsSinceChange = 0;
+		blocksUnderRestoreLoad = 0;
+		return true;
+	}
+
+	QualityState QualityController::getState() const
+	{
+		QualityState state {};
+		state.load = smoothedLoad;
+		state.level = (UInt32) level;
+		state.numDegrades = numDegrades;
+		state.numRestores = numRestores;
+		return state;
+	}
+}
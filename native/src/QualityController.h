@@ -0,0 +1,76 @@
+#pragma once
+
+#include "AudioPluginUtil.h"
+
+namespace BRTSpatialiserCore
+{
+	// Rendering quality, from full down. Each level keeps the reductions of the levels above it. Values must be
+	// kept in sync with the QualityLevel enum in c# code.
+	enum QualityLevel : int
+	{
+		QualityFull = 0,
+		QualityNoDistantReverb = 1,  // Sources further than reverbDistance stop feeding the BRIR models
+		QualityNoInterpolation = 2,  // HRTF interpolation and the near field filters are off for every listener
+		QualityEconomy = 3,          // The furthest sources are only repositioned every few blocks. That only
+		                             // saves the per-move work, their convolution costs the same, so it is not
+		                             // part of the default range.
+		NumQualityLevels = 4,
+	};
+
+	struct QualitySettings
+	{
+		bool isEnabled = false;  // Opt in, as it changes the render
+		int maxLevel = QualityNoInterpolation;
+		float degradeLoad = 0.8f;      // Smoothed block time / deadline above which quality steps down
+		float restoreLoad = 0.5f;      // Smoothed load that must hold for restoreTime before quality steps up
+		float restoreTime = 2.0f;      // Seconds
+		float reverbDistance = 10.0f;  // Metres
+		float economyShare = 0.5f;     // Share of the sources, furthest first, that QualityEconomy applies to
+	};
+
+	// Observed state of the controller. Layout must be kept in sync with the QualityState struct in c# code,
+	// and every field is 4 bytes so it can also be read as an array of floats through GetFloatBufferCallback.
+	struct QualityState
+	{
+		float load;                     // Smoothed block time / deadline
+		UInt32 level;                   // QualityLevel
+		UInt32 numDegrades;             // Since the core was created
+		UInt32 numRestores;
+		UInt32 sourcesWithoutReverb;    // Sources QualityNoDistantReverb currently applies to
+		UInt32 economySources;          // Sources QualityEconomy currently applies to
+	};
+
+	//==========================================================================
+	// Picks the quality level from the time each block takes against its deadline. Quality steps down one level
+	// when the smoothed load passes degradeLoad or blocks overrun, and then waits for the step to show in the
+	// timings before it takes another. It steps back up one level at a time, only after the load has stayed
+	// under restoreLoad for restoreTime, so a scene near the limit doesn't flip between levels. Applying a level
+	// is left to SpatialiserCore. Every method must be called with SpatialiserCore::mutex locked.
+	class QualityController
+	{
+	public:
+		QualitySettings settings;
+
+		// Called by the manager after every block with its time and deadline in milliseconds. Returns true if
+		// the level changed.
+		bool update (float blockTime, float deadline);
+
+		QualityLevel getLevel() const { return level; }
+		// Blocks seen so far, for spreading periodic work over sources
+		UInt32 getBlockCount() const { return blockCount; }
+		// Fills everything but the source counts, which only the core knows
+		QualityState getState() const;
+
+	private:
+		bool setLevel (QualityLevel newLevel);
+
+		QualityLevel level = QualityFull;
+		float smoothedLoad = 0.0f;
+		UInt32 blockCount = 0;
+		UInt32 blocksSinceChange = 0;
+		UInt32 overrunsSinceChange = 0;
+		UInt32 blocksUnderRestoreLoad = 0;
+		UInt32 numDegrades = 0;
+		UInt32 numRestores = 0;
+	};
+}
@@ -0,0 +1,297 @@
+#include "ResourceLoader.h"
+
+namespace BRTSpatialiserCore
+{
+	// Finished jobs that C# never released are dropped beyond this many
+	const size_t MaxRetainedJobs = 64;
+	// How often a worker with published jobs checks whether the core has finished with them
+	const std::chrono::milliseconds RetirePollInterval (100);
+
+	bool IsFinished (int status)
+	{
+		return status == LoadCompleted || status == LoadFailed || status == LoadSuperseded;
+	}
+
+	ResourceLoader& ResourceLoader::instance()
+	{
+		static ResourceLoader loader;
+		return loader;
+	}
+
+	ResourceLoader::~ResourceLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock (queueMutex);
+			stopping = true;
+		}
+		queueChanged.notify_all();
+
+		for (auto& worker : workers)
+			if (worker.joinable())
+				worker.join();
+	}
+
+	int ResourceLoader::enqueue (BinaryRole role, std::string path, const TableSettings& settings, Handle listener)
+	{
+		auto job = std::make_shared<LoadJob>();
+		job->role = role;
+		job->listener = listener;
+		job->path = std::move (path);
+		job->settings = settings;
+
+		{
+			std::lock_guard<std::mutex> lock (queueMutex);
+
+			job->handle = nextHandle++;
+			latestRequest[getSlotIndex (role, listener)] = job->handle;
+			queues[role].push_back (job);
+			jobs[job->handle] = job;
+
+			for (auto it = jobs.begin(); jobs.size() > MaxRetainedJobs && it != jobs.end();)
+			{
+				it = IsFinished (it->second->status) ? jobs.erase (it) : std::next (it);
+			}
+
+			// Workers are started lazily so that merely loading the plugin spawns no threads
+			if (! workers[role].joinable())
+				workers[role] = std::thread (&ResourceLoader::run, this, role);
+		}
+		queueChanged.notify_all();
+
+		return job->handle;
+	}
+
+	LoadStatus ResourceLoader::getStatus (int handle, float* progress)
+	{
+		std::lock_guard<std::mutex> lock (queueMutex);
+
+		auto it = jobs.find (handle);
+		if (it == jobs.end())
+			return LoadInvalidHandle;
+
+		if (progress != nullptr)
+			*progress = it->second->progress;
+		return (LoadStatus) it->second->status.load();
+	}
+
+	void ResourceLoader::release (int handle)
+	{
+		std::lock_guard<std::mutex> lock (queueMutex);
+		jobs.erase (handle);
+	}
+
+	void ResourceLoader::supersede (BinaryRole role, Handle listener)
+	{
+		std::lock_guard<std::mutex> lock (queueMutex);
+		const size_t slot = getSlotIndex (role, listener);
+		latestRequest[slot] = nextHandle++;
+
+		if (LoadJob* job = pending[slot].exchange (nullptr))
+			job->status = LoadSuperseded;
+	}
+
+	LoadJob* ResourceLoader::takePending (BinaryRole role, size_t listenerIndex)
+	{
+		return pending[role * SpatialiserCore::MaxListeners + listenerIndex].exchange (nullptr);
+	}
+
+	void ResourceLoader::publish (const std::shared_ptr<LoadJob>& job)
+	{
+		job->status = LoadReady;
+		published[job->role].push_back (job);
+
+		// Anything the core has not picked up yet is older than this job, so it is simply replaced
+		if (LoadJob* replaced = pending[getSlotIndex (job->role, job->listener)].exchange (job.get()))
+			replaced->status = LoadSuperseded;
+	}
+
+	void ResourceLoader::retireFinished (BinaryRole role)
+	{
+		std::vector<std::shared_ptr<LoadJob>> finished;
+		{
+			std::lock_guard<std::mutex> lock (queueMutex);
+			auto& jobsOfRole = published[role];
+			for (auto it = jobsOfRole.begin(); it != jobsOfRole.end();)
+			{
+				if (IsFinished ((*it)->status))
+				{
+					finished.push_back (std::move (*it));
+					it = jobsOfRole.erase (it);
+				}
+				else
+					++it;
+			}
+		}
+
+		for (const auto& job : finished)
+		{
+			if (job->status == LoadCompleted)
+				WriteLog ("BRT: Installed " + job->description);
+			else if (job->status == LoadFailed)
+				WriteLog ("BRT: Could not install " + job->description);
+
+			// After an install this is the binary that was replaced
+			job->result = LoadedBinary();
+		}
+	}
+
+	void ResourceLoader::run (BinaryRole role)
+	{
+		for (;;)
+		{
+			std::shared_ptr<LoadJob> job;
+			{
+				std::unique_lock<std::mutex> lock (queueMutex);
+				const auto hasWork = [&] { return stopping || ! queues[role].empty(); };
+
+				// Only poll while the core may still hand something back to be freed
+				if (published[role].empty())
+					queueChanged.wait (lock, hasWork);
+				else
+					queueChanged.wait_for (lock, RetirePollInterval, hasWork);
+
+				if (stopping)
+					return;
+
+				if (! queues[role].empty())
+				{
+					job = queues[role].front();
+					queues[role].pop_front();
+				}
+			}
+
+			retireFinished (role);
+
+			if (job == nullptr)
+				continue;
+
+			if (! isLatest (*job))
+			{
+				job->status = LoadSuperseded;
+				continue;
+			}
+
+			job->status = LoadInProgress;
+			job->result = SpatialiserCore::readBinary (role, job->path, job->settings, &job->progress);
+			job->description = SpatialiserCore::describeBinary (job->result);
+
+			bool isPublished = false;
+			{
+				std::lock_guard<std::mutex> lock (queueMutex);
+				if (! job->result.succeeded)
+					job->status = LoadFailed;
+				else if (! isLatest (*job))
+					job->status = LoadSuperseded;
+				else
+				{
+					publish (job);
+					isPublished = true;
+				}
+			}
+
+			if (! isPublished)
+			{
+				if (job->status == LoadFailed)
+					WriteLog ("BRT: Could not read " + job->description);
+				job->result = LoadedBinary();
+			}
+		}
+	}
+
+	//==========================================================================
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    int BRTSpatialiserLoadBinaryAsync (BinaryRole role, const char* path, int currentSampleRate, int dspBufferSize)
+	{
+		if (role < 0 || role >= NumBinaryRoles || path == nullptr)
+			return 0;
+
+		TableSettings settings;
+		{
+			std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+			// Creates the core if necessary so that the BRT global sample rate is set before the worker reads the file
+			try
+			{
+				SpatialiserCore* spatializer = SpatialiserCore::instance (currentSampleRate, dspBufferSize);
+				spatializer->requestedPaths[role] = path;
+				settings = spatializer->tableSettings;
+			}
+			catch (const SpatialiserCore::IncorrectAudioStateException& e)
+			{
+				WriteLog (std::string ("Error: BRTSpatialiserLoadBinaryAsync called with incorrect audio state. ") + e.what());
+				return 0;
+			}
+		}
+
+		return ResourceLoader::instance().enqueue (role, path, settings);
+	}
+
+	// Loads a resource for an additional listener alone, which then stops following listener 0 for that role. Given
+	// listener 0 this is the same as BRTSpatialiserLoadBinaryAsync.
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    int BRTSpatialiserLoadListenerBinaryAsync (Handle listenerHandle, BinaryRole role, const char* path, int currentSampleRate, int dspBufferSize)
+	{
+		if (role < 0 || role >= NumBinaryRoles || path == nullptr || *path == '\0')
+			return 0;
+
+		TableSettings settings;
+		{
+			std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+			try
+			{
+				SpatialiserCore* spatializer = SpatialiserCore::instance (currentSampleRate, dspBufferSize);
+
+				if (listenerHandle == spatializer->getMainListenerHandle())
+				{
+					spatializer->requestedPaths[role] = path;
+					settings = spatializer->tableSettings;
+					listenerHandle = InvalidHandle;
+				}
+				else if (ListenerSlot* slot = spatializer->getListener (listenerHandle))
+				{
+					slot->requestedPaths[role] = path;
+					settings = spatializer->tableSettings;
+				}
+				else
+					return 0;
+			}
+			catch (const SpatialiserCore::IncorrectAudioStateException& e)
+			{
+				WriteLog (std::string ("Error: BRTSpatialiserLoadListenerBinaryAsync called with incorrect audio state. ") + e.what());
+				return 0;
+			}
+		}
+
+		return ResourceLoader::instance().enqueue (role, path, settings, listenerHandle);
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    int BRTSpatialiserGetLoadStatus (int handle, float* progress)
+	{
+		ResourceLoader& loader = ResourceLoader::instance();
+		LoadStatus status = loader.getStatus (handle, progress);
+
+		// Normally the manager installs the resource at the start of the next block. If the audio thread is not
+		// running there is nobody to do that so polling completes the hand-off instead.
+		if (status == LoadReady)
+		{
+			std::unique_lock<std::mutex> lock (SpatialiserCore::mutex(), std::try_to_lock);
+			if (lock.owns_lock())
+			{
+				if (SpatialiserCore* spatializer = SpatialiserCore::instance())
+				{
+					spatializer->applyPendingBinaries();
+					status = loader.getStatus (handle, progress);
+				}
+			}
+		}
+		return status;
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    void BRTSpatialiserReleaseLoadJob (int handle)
+	{
+		ResourceLoader::instance().release (handle);
+	}
+}
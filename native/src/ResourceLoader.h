@@ -0,0 +1,100 @@
+#pragma once
+
+#include "SpatialiserCore.h"
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace BRTSpatialiserCore
+{
+	enum LoadStatus : int
+	{
+		// Must be kept in sync with the BinaryLoadStatus enum in c# code
+		LoadInvalidHandle = -1,
+		LoadQueued = 0,
+		LoadInProgress = 1,
+		LoadReady = 2,      // Read, waiting for the core to install it at the start of the next block
+		LoadCompleted = 3,  // Installed on the listener
+		LoadFailed = 4,
+		LoadSuperseded = 5, // A later request for the same role replaced this one
+	};
+
+	struct LoadJob
+	{
+		int handle = 0;
+		BinaryRole role = NumBinaryRoles;
+		// The additional listener the resource is for alone, or InvalidHandle for listener 0 and its followers
+		Handle listener = InvalidHandle;
+		std::string path;
+		TableSettings settings;
+		std::atomic<int> status { LoadQueued };
+		std::atomic<float> progress { 0.0f };
+		// The binary read. Installing it swaps in whatever it replaced, which the worker then frees.
+		LoadedBinary result;
+		// What was read, for the worker to log once the job is finished
+		std::string description;
+	};
+
+	//==========================================================================
+	// Reads binary resources on background threads so the Unity main thread never blocks on a SOFA parse.
+	// There is one worker per BinaryRole, so the HRTF, ILD and BRIR load concurrently while repeated requests
+	// for the same role are served in order. A finished job is published through an atomic slot per role and
+	// listener which SpatialiserCore::applyPendingBinaries drains, so the workers never take SpatialiserCore::mutex.
+	//
+	// The audio thread only borrows a published job. Its worker keeps it and, once the job is finished, logs
+	// it and frees the tables it carries, so neither the logging nor the deallocation of a replaced table
+	// happens in the render callback.
+	class ResourceLoader
+	{
+	public:
+		static ResourceLoader& instance();
+		~ResourceLoader();
+
+		// Queues a read of path for the given role and returns a handle for polling, never 0. If listener is given
+		// the resource is installed on that listener alone.
+		int enqueue (BinaryRole role, std::string path, const TableSettings& settings, Handle listener = InvalidHandle);
+		// Returns the status of a job and, if progress is not null, its progress between 0 and 1.
+		LoadStatus getStatus (int handle, float* progress);
+		// Forgets a job. Its resource is still installed if it has not been already.
+		void release (int handle);
+		// Makes any queued or pending job for this role and listener obsolete, e.g. because a synchronous load
+		// replaced it.
+		void supersede (BinaryRole role, Handle listener = InvalidHandle);
+		// Takes the most recent finished job for role and the listener at listenerIndex, or returns nullptr. Jobs
+		// for listener 0 and its followers are at index 0. Lock free and allocation free. The job
+		// stays owned by the loader: the caller must set its status to LoadCompleted or LoadFailed once done with
+		// it and not touch it afterwards.
+		LoadJob* takePending (BinaryRole role, size_t listenerIndex = 0);
+
+	private:
+		ResourceLoader() = default;
+		void run (BinaryRole role);
+		// Must be called with queueMutex held, which makes checking isLatest and publishing one step
+		void publish (const std::shared_ptr<LoadJob>& job);
+		// Logs and frees the published jobs of role that the core is done with
+		void retireFinished (BinaryRole role);
+		bool isLatest (const LoadJob& job) const { return latestRequest[getSlotIndex (job.role, job.listener)].load() == job.handle; }
+
+		static constexpr size_t NumSlots = NumBinaryRoles * SpatialiserCore::MaxListeners;
+		static size_t getSlotIndex (BinaryRole role, Handle listener)
+		{
+			return role * SpatialiserCore::MaxListeners + (listener != InvalidHandle ? GetHandleIndex (listener) : 0);
+		}
+
+		std::mutex queueMutex;
+		std::condition_variable queueChanged;
+		bool stopping = false;
+		int nextHandle = 1;
+		std::array<std::deque<std::shared_ptr<LoadJob>>, NumBinaryRoles> queues;
+		std::array<std::thread, NumBinaryRoles> workers;
+		std::map<int, std::shared_ptr<LoadJob>> jobs;
+
+		std::array<std::atomic<int>, NumSlots> latestRequest {};
+		std::array<std::atomic<LoadJob*>, NumSlots> pending {};
+		// Owners of every job published and not yet retired, guarded by queueMutex
+		std::array<std::vector<std::shared_ptr<LoadJob>>, NumBinaryRoles> published;
+	};
+}
@@ -0,0 +1,149 @@
+#include "ResourceRegistry.h"
+#include <fstream>
+#include <vector>
+#include <sys/stat.h>
+
+namespace BRTSpatialiserCore
+{
+	namespace
+	{
+		// Identifies a version of a file without reading it
+		struct FileStamp
+		{
+			long long size = 0;
+			long long modified = 0;
+
+			bool operator== (const FileStamp& other) const { return size == other.size && modified == other.modified; }
+		};
+
+		bool GetFileStamp (const std::string& path, FileStamp& stamp)
+		{
+#ifdef _WIN32
+			struct _stat64 info;
+			if (_stat64 (path.c_str(), &info) != 0)
+				return false;
+#else
+			struct stat info;
+			if (stat (path.c_str(), &info) != 0)
+				return false;
+#endif
+			stamp.size = (long long) info.st_size;
+			stamp.modified = (long long) info.st_mtime;
+			return true;
+		}
+
+		UInt64 HashStream (std::ifstream& file)
+		{
+			UInt64 hash = 0xcbf29ce484222325ull;
+			std::vector<char> chunk (1 << 16);
+
+			while (file)
+			{
+				file.read (chunk.data(), (std::streamsize) chunk.size());
+				const std::streamsize numRead = file.gcount();
+
+				for (std::streamsize i = 0; i < numRead; ++i)
+				{
+					hash ^= (unsigned char) chunk[(size_t) i];
+					hash *= 0x100000001b3ull;
+				}
+			}
+			return hash;
+		}
+	}
+
+	UInt64 HashFileContents (const std::string& path)
+	{
+		static std::mutex cacheMutex;
+		static std::map<std::string, std::pair<FileStamp, UInt64>> cache;
+
+		FileStamp stamp;
+		const bool hasStamp = GetFileStamp (path, stamp);
+		if (hasStamp)
+		{
+			std::lock_guard<std::mutex> lock (cacheMutex);
+			auto it = cache.find (path);
+			if (it != cache.end() && it->second.first == stamp)
+				return it->second.second;
+		}
+
+		std::ifstream file (path, std::ios::binary);
+		if (! file)
+			return 0;
+
+		const UInt64 hash = HashStream (file);
+		if (hasStamp)
+		{
+			std::lock_guard<std::mutex> lock (cacheMutex);
+			cache[path] = { stamp, hash };
+		}
+		return hash;
+	}
+
+	ResourceRegistry& ResourceRegistry::instance()
+	{
+		static ResourceRegistry registry;
+		return registry;
+	}
+
+	size_t ResourceRegistry::getNumResources()
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		removeExpiredEntries();
+		return entries.size();
+	}
+
+	std::shared_ptr<void> ResourceRegistry::acquireErased (const ResourceKey& key, const std::function<std::shared_ptr<void>()>& build)
+	{
+		// Without a hash there is nothing to share against
+		if (key.contentHash == 0)
+			return build();
+
+		std::unique_lock<std::mutex> lock (mutex);
+		removeExpiredEntries();
+
+		Entry& entry = entries[key];
+		if (auto existing = entry.resource.lock())
+			return existing;
+
+		if (entry.building.valid())
+		{
+			auto building = entry.building;
+			lock.unlock();
+			return building.get();
+		}
+
+		std::promise<std::shared_ptr<void>> promise;
+		entry.building = promise.get_future().share();
+		lock.unlock();
+
+		std::shared_ptr<void> resource;
+		try
+		{
+			resource = build();
+		}
+		catch (...)
+		{
+		}
+
+		// removeExpiredEntries skips entries that are building, so entry is still valid here
+		lock.lock();
+		entry.building = {};
+		entry.resource = resource;
+		lock.unlock();
+
+		promise.set_value (resource);
+		return resource;
+	}
+
+	void ResourceRegistry::removeExpiredEntries()
+	{
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			if (it->second.resource.expired() && ! it->second.building.valid())
+				it = entries.erase (it);
+			else
+				++it;
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "AudioPluginInterface.h"
+
+namespace BRTSpatialiserCore
+{
+	// Identifies a loaded table by what went into building it rather than by where the file came from, so the
+	// same resource saved to a different path (as Spatializer.cs does on every platform) is still shared.
+	struct ResourceKey
+	{
+		UInt64 contentHash = 0;
+		UInt32 sampleRate = 0;
+		int resamplingStep = 0;  // 0 for resources that are not resampled
+		int storageFormat = 0;   // BRTHelpers::SampleFormat, for resources held in our own storage
+		float headRadius = -1.0f; // Head radius set on an HRTF, negative if left as the file gives it
+		int customITD = -1;      // 1 or 0 if an HRTF's custom ITD was switched on or off, -1 if left alone
+		int role = 0;
+
+		bool operator< (const ResourceKey& other) const
+		{
+			return std::tie (contentHash, sampleRate, resamplingStep, storageFormat, headRadius, customITD, role)
+			     < std::tie (other.contentHash, other.sampleRate, other.resamplingStep, other.storageFormat, other.headRadius,
+			                 other.customITD, other.role);
+		}
+	};
+
+	// 64 bit FNV-1a hash of a file's contents. Returns 0 if the file can't be read. The hash is remembered by path,
+	// size and modification time so loading the same file again doesn't read it again.
+	UInt64 HashFileContents (const std::string& path);
+
+	//==========================================================================
+	// Process-wide cache of loaded HRTF, BRIR and near-field tables. The registry only holds weak references:
+	// a table lives for as long as some listener or core holds the shared_ptr handed out by acquire(), and is
+	// freed as soon as the last one lets go. Loading something already alive costs just the content hash.
+	// Resources are never modified once acquire() has returned them, so anything that changes a table, like the
+	// head radius BRT keeps on the CHRTF, must be part of its key.
+	class ResourceRegistry
+	{
+	public:
+		static ResourceRegistry& instance();
+
+		// Returns the live resource for key or, if there is none, the result of build(). Concurrent requests for a
+		// key being built wait for that build instead of starting their own. A null result is not cached.
+		template <typename T>
+		std::shared_ptr<T> acquire (const ResourceKey& key, const std::function<std::shared_ptr<T>()>& build)
+		{
+			return std::static_pointer_cast<T> (acquireErased (key, [&build]() -> std::shared_ptr<void> { return build(); }));
+		}
+
+		// Number of tables currently alive
+		size_t getNumResources();
+
+	private:
+		ResourceRegistry() = default;
+		std::shared_ptr<void> acquireErased (const ResourceKey& key, const std::function<std::shared_ptr<void>()>& build);
+		void removeExpiredEntries();
+
+		struct Entry
+		{
+			std::weak_ptr<void> resource;
+			std::shared_future<std::shared_ptr<void>> building;
+		};
+
+		std::mutex mutex;
+		std::map<ResourceKey, Entry> entries;
+	};
+}
@@ -0,0 +1,55 @@
+#include "SceneSnapshot.h"
+#include <algorithm>
+
+namespace BRTSpatialiserCore
+{
+	SceneSnapshot& SceneSnapshot::instance()
+	{
+		static SceneSnapshot snapshot;
+		return snapshot;
+	}
+
+	SceneSnapshot::SceneSnapshot()
+	{
+		const size_t floatsPerBuffer = (3 + NumSourceParameters) * (size_t) Capacity;
+		handleStorage.resize (buffers.size() * Capacity);
+		floatStorage.resize (buffers.size() * floatsPerBuffer);
+
+		for (size_t b = 0; b < buffers.size(); ++b)
+		{
+			float* floats = floatStorage.data() + b * floatsPerBuffer;
+
+			SceneBuffer& buffer = buffers[b];
+			buffer.sources = handleStorage.data() + b * Capacity;
+			buffer.positionX = floats;
+			buffer.positionY = floats + Capacity;
+			buffer.positionZ = floats + 2 * Capacity;
+			buffer.parameters = floats + 3 * Capacity;
+			buffer.capacity = Capacity;
+			buffer.numSources = 0;
+			buffer.hasParameters = 0;
+		}
+	}
+
+	SceneBuffer* SceneSnapshot::publish()
+	{
+		SceneBuffer& written = buffers[writeIndex];
+		written.numSources = std::clamp (written.numSources, 0, Capacity);
+
+		writeIndex = latest.exchange (writeIndex | FreshFlag, std::memory_order_acq_rel) & ~FreshFlag;
+
+		SceneBuffer& next = buffers[writeIndex];
+		next.numSources = 0;
+		next.hasParameters = 0;
+		return &next;
+	}
+
+	SceneBuffer* SceneSnapshot::acquire()
+	{
+		if ((latest.load (std::memory_order_relaxed) & FreshFlag) == 0)
+			return nullptr;
+
+		readIndex = latest.exchange (readIndex, std::memory_order_acq_rel) & ~FreshFlag;
+		return &buffers[readIndex];
+	}
+}
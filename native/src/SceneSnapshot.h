@@ -0,0 +1,57 @@
+#pragma once
+
+#include "SpatialiserCore.h"
+
+namespace BRTSpatialiserCore
+{
+	// One buffer of a scene snapshot. Every field is its own array so C# or a Burst job can fill it in a tight
+	// loop and the audio thread can scale a whole field at once. Layout must be kept in sync with the
+	// SceneBuffer struct in c# code.
+	struct SceneBuffer
+	{
+		Handle* sources;     // From Spatializer.GetSourceHandle. Stale handles are skipped.
+		float* positionX;    // World position in Unity units, before the scale factor
+		float* positionY;
+		float* positionZ;
+		float* parameters;   // Per-source parameter p of source i is at p * capacity + i. NaN leaves it unchanged.
+		int capacity;
+		int numSources;      // Set by the writer before publishing
+		int hasParameters;   // Set by the writer if parameters was filled in
+	};
+
+	//==========================================================================
+	// Lets the game thread hand the positions and parameters of every source to the audio thread in one go,
+	// instead of each spatialiser decoding its own matrix. Three buffers rotate between the writer, the reader
+	// and the most recently published snapshot, so publishing and acquiring are each a single atomic exchange
+	// and neither side ever waits for the other.
+	//
+	// The snapshot is process wide rather than part of the SpatialiserCore so that C# can write it without
+	// taking SpatialiserCore::mutex.
+	class SceneSnapshot
+	{
+	public:
+		static constexpr int Capacity = 4096;
+
+		static SceneSnapshot& instance();
+
+		// Writer side. Only one thread may write at a time.
+		SceneBuffer* getWriteBuffer() { return &buffers[writeIndex]; }
+		// Makes the write buffer the latest snapshot and returns the buffer to write next
+		SceneBuffer* publish();
+
+		// Reader side. Returns the latest snapshot if one was published since the last call, nullptr otherwise.
+		SceneBuffer* acquire();
+
+	private:
+		SceneSnapshot();
+
+		static constexpr int FreshFlag = 4;
+
+		std::vector<Handle> handleStorage;
+		std::vector<float> floatStorage;
+		std::array<SceneBuffer, 3> buffers;
+		int writeIndex = 0;
+		int readIndex = 1;
+		std::atomic<int> latest { 2 };  // Index of the latest buffer, plus FreshFlag if the reader hasn't seen it
+	};
+}
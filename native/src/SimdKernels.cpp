@@ -0,0 +1,241 @@
+#include "SimdKernels.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+#if BRT_X86_DISPATCH
+ #include <immintrin.h>
+#endif
+
+// Every x86 variant is written with the intrinsics of its instruction set, so the variants differ whichever
+// compiler builds them: MSVC would not vectorise a plain loop for a wider set than the build targets. Each
+// variant finishes with the scalar loop, which is all other architectures use (arm64 compilers vectorise it
+// for NEON). The variant is picked on the first call.
+namespace BRTHelpers
+{
+    namespace
+    {
+        void AccumulateWeightedScalar (float* destination, const float* source, size_t begin, size_t count, float weight)
+        {
+            for (size_t i = begin; i < count; ++i)
+                destination[i] += weight * source[i];
+        }
+
+        void DownmixStereoScalar (const float* interleaved, float* mono, size_t begin, size_t numFrames, float gain)
+        {
+            const float scale = gain / 2.0f;
+            for (size_t i = begin; i < numFrames; ++i)
+                mono[i] = (interleaved[2 * i] + interleaved[2 * i + 1]) * scale;
+        }
+
+        void InterleaveStereoScalar (const float* left, const float* right, float* interleaved, size_t begin, size_t numFrames)
+        {
+            for (size_t i = begin; i < numFrames; ++i)
+            {
+                interleaved[2 * i + 0] = left[i];
+                interleaved[2 * i + 1] = right[i];
+            }
+        }
+
+        void MeasureLanesScalar (const float* samples, size_t begin, size_t numSamples, float* peaks, float* sums)
+        {
+            for (size_t i = begin; i < numSamples; ++i)
+            {
+                const float x = samples[i];
+                peaks[i % LevelLanes] = std::max (peaks[i % LevelLanes], std::fabs (x));
+                sums[i % LevelLanes] += x * x;
+            }
+        }
+
+#if BRT_X86_DISPATCH
+        // SSE2 is part of x86_64, so these are the baseline. Nothing here gains from SSE4.2, which uses them too.
+
+        void AccumulateWeightedSSE (float* destination, const float* source, size_t count, float weight)
+        {
+            const __m128 w = _mm_set1_ps (weight);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps (destination + i, _mm_add_ps (_mm_loadu_ps (destination + i), _mm_mul_ps (w, _mm_loadu_ps (source + i))));
+            AccumulateWeightedScalar (destination, source, i, count, weight);
+        }
+
+        void DownmixStereoSSE (const float* interleaved, float* mono, size_t numFrames, float gain)
+        {
+            const __m128 scale = _mm_set1_ps (gain / 2.0f);
+            size_t i = 0;
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                const __m128 a = _mm_loadu_ps (interleaved + 2 * i);      // L0 R0 L1 R1
+                const __m128 b = _mm_loadu_ps (interleaved + 2 * i + 4);  // L2 R2 L3 R3
+                const __m128 left = _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+                const __m128 right = _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+                _mm_storeu_ps (mono + i, _mm_mul_ps (_mm_add_ps (left, right), scale));
+            }
+            DownmixStereoScalar (interleaved, mono, i, numFrames, gain);
+        }
+
+        void InterleaveStereoSSE (const float* left, const float* right, float* interleaved, size_t numFrames)
+        {
+            size_t i = 0;
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                const __m128 l = _mm_loadu_ps (left + i);
+                const __m128 r = _mm_loadu_ps (right + i);
+                _mm_storeu_ps (interleaved + 2 * i, _mm_unpacklo_ps (l, r));
+                _mm_storeu_ps (interleaved + 2 * i + 4, _mm_unpackhi_ps (l, r));
+            }
+            InterleaveStereoScalar (left, right, interleaved, i, numFrames);
+        }
+
+        // Two registers of four lanes
+        void MeasureLanesSSE (const float* samples, size_t numSamples, float* peaks, float* sums)
+        {
+            const __m128 signMask = _mm_set1_ps (-0.0f);
+            __m128 p0 = _mm_loadu_ps (peaks), p1 = _mm_loadu_ps (peaks + 4);
+            __m128 s0 = _mm_loadu_ps (sums), s1 = _mm_loadu_ps (sums + 4);
+
+            const size_t vectorEnd = numSamples - numSamples % LevelLanes;
+            for (size_t i = 0; i < vectorEnd; i += LevelLanes)
+            {
+                const __m128 x0 = _mm_loadu_ps (samples + i);
+                const __m128 x1 = _mm_loadu_ps (samples + i + 4);
+                p0 = _mm_max_ps (p0, _mm_andnot_ps (signMask, x0));
+                p1 = _mm_max_ps (p1, _mm_andnot_ps (signMask, x1));
+                s0 = _mm_add_ps (s0, _mm_mul_ps (x0, x0));
+                s1 = _mm_add_ps (s1, _mm_mul_ps (x1, x1));
+            }
+
+            _mm_storeu_ps (peaks, p0);
+            _mm_storeu_ps (peaks + 4, p1);
+            _mm_storeu_ps (sums, s0);
+            _mm_storeu_ps (sums + 4, s1);
+            MeasureLanesScalar (samples, vectorEnd, numSamples, peaks, sums);
+        }
+
+        BRT_TARGET_AVX2 void AccumulateWeightedAVX2 (float* destination, const float* source, size_t count, float weight)
+        {
+            const __m256 w = _mm256_set1_ps (weight);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+                _mm256_storeu_ps (destination + i, _mm256_fmadd_ps (w, _mm256_loadu_ps (source + i), _mm256_loadu_ps (destination + i)));
+            AccumulateWeightedScalar (destination, source, i, count, weight);
+        }
+
+        BRT_TARGET_AVX2 void DownmixStereoAVX2 (const float* interleaved, float* mono, size_t numFrames, float gain)
+        {
+            const __m256 scale = _mm256_set1_ps (gain / 2.0f);
+            size_t i = 0;
+            for (; i + 8 <= numFrames; i += 8)
+            {
+                const __m256 a = _mm256_loadu_ps (interleaved + 2 * i);      // L0 R0 .. L3 R3
+                const __m256 b = _mm256_loadu_ps (interleaved + 2 * i + 8);  // L4 R4 .. L7 R7
+                // Shuffles stay within 128 bit halves, leaving the frames in the order 0 1 4 5 2 3 6 7
+                const __m256 left = _mm256_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+                const __m256 right = _mm256_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+                const __m256 sum = _mm256_add_ps (left, right);
+                const __m256 ordered = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (sum), _MM_SHUFFLE (3, 1, 2, 0)));
+                _mm256_storeu_ps (mono + i, _mm256_mul_ps (ordered, scale));
+            }
+            DownmixStereoScalar (interleaved, mono, i, numFrames, gain);
+        }
+
+        BRT_TARGET_AVX2 void InterleaveStereoAVX2 (const float* left, const float* right, float* interleaved, size_t numFrames)
+        {
+            size_t i = 0;
+            for (; i + 8 <= numFrames; i += 8)
+            {
+                const __m256 l = _mm256_loadu_ps (left + i);
+                const __m256 r = _mm256_loadu_ps (right + i);
+                // Frames 0 1 4 5 and 2 3 6 7, regrouped by 128 bit half
+                const __m256 low = _mm256_unpacklo_ps (l, r);
+                const __m256 high = _mm256_unpackhi_ps (l, r);
+                _mm256_storeu_ps (interleaved + 2 * i, _mm256_permute2f128_ps (low, high, 0x20));
+                _mm256_storeu_ps (interleaved + 2 * i + 8, _mm256_permute2f128_ps (low, high, 0x31));
+            }
+            InterleaveStereoScalar (left, right, interleaved, i, numFrames);
+        }
+
+        // One register holds every lane
+        BRT_TARGET_AVX2 void MeasureLanesAVX2 (const float* samples, size_t numSamples, float* peaks, float* sums)
+        {
+            const __m256 signMask = _mm256_set1_ps (-0.0f);
+            __m256 p = _mm256_loadu_ps (peaks);
+            __m256 s = _mm256_loadu_ps (sums);
+
+            const size_t vectorEnd = numSamples - numSamples % LevelLanes;
+            for (size_t i = 0; i < vectorEnd; i += LevelLanes)
+            {
+                const __m256 x = _mm256_loadu_ps (samples + i);
+                p = _mm256_max_ps (p, _mm256_andnot_ps (signMask, x));
+                s = _mm256_fmadd_ps (x, x, s);
+            }
+
+            _mm256_storeu_ps (peaks, p);
+            _mm256_storeu_ps (sums, s);
+            MeasureLanesScalar (samples, vectorEnd, numSamples, peaks, sums);
+        }
+
+        // Only interpolation at load runs long enough for AVX-512's wider registers to pay off. The per block
+        // kernels see a few hundred samples and use their AVX2 variant on AVX-512 machines.
+        BRT_TARGET_AVX512 void AccumulateWeightedAVX512 (float* destination, const float* source, size_t count, float weight)
+        {
+            const __m512 w = _mm512_set1_ps (weight);
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16)
+                _mm512_storeu_ps (destination + i, _mm512_fmadd_ps (w, _mm512_loadu_ps (source + i), _mm512_loadu_ps (destination + i)));
+            AccumulateWeightedScalar (destination, source, i, count, weight);
+        }
+
+        template <typename Function>
+        Function SelectVariant (Function sse, Function avx2, Function avx512 = nullptr)
+        {
+            switch (GetCpuLevel())
+            {
+                case CpuLevel::AVX512: return avx512 != nullptr ? avx512 : avx2;
+                case CpuLevel::AVX2:   return avx2;
+                default:               return sse;
+            }
+        }
+#endif
+    }
+
+    void AccumulateWeighted (float* destination, const float* source, size_t count, float weight)
+    {
+#if BRT_X86_DISPATCH
+        static const auto kernel = SelectVariant (AccumulateWeightedSSE, AccumulateWeightedAVX2, AccumulateWeightedAVX512);
+        kernel (destination, source, count, weight);
+#else
+        AccumulateWeightedScalar (destination, source, 0, count, weight);
+#endif
+    }
+
+    void DownmixStereo (const float* interleaved, float* mono, size_t numFrames, float gain)
+    {
+#if BRT_X86_DISPATCH
+        static const auto kernel = SelectVariant (DownmixStereoSSE, DownmixStereoAVX2);
+        kernel (interleaved, mono, numFrames, gain);
+#else
+        DownmixStereoScalar (interleaved, mono, 0, numFrames, gain);
+#endif
+    }
+
+    void InterleaveStereo (const float* left, const float* right, float* interleaved, size_t numFrames)
+    {
+#if BRT_X86_DISPATCH
+        static const auto kernel = SelectVariant (InterleaveStereoSSE, InterleaveStereoAVX2);
+        kernel (left, right, interleaved, numFrames);
+#else
+        InterleaveStereoScalar (left, right, interleaved, 0, numFrames);
+#endif
+    }
+
+    void MeasureLanes (const float* samples, size_t numSamples, float* peaks, float* sums)
+    {
+#if BRT_X86_DISPATCH
+        static const auto kernel = SelectVariant (MeasureLanesSSE, MeasureLanesAVX2);
+        kernel (samples, numSamples, peaks, sums);
+#else
+        MeasureLanesScalar (samples, 0, numSamples, peaks, sums);
+#endif
+    }
+}
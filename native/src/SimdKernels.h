@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+namespace BRTHelpers
+{
+    // destination[i] += weight * source[i]. The inner loop of HRIR interpolation from float tables.
+    void AccumulateWeighted (float* destination, const float* source, size_t count, float weight);
+
+    // Averages the channels of an interleaved stereo buffer into mono, scaled by gain. This is how the spatialiser
+    // feeds a source.
+    void DownmixStereo (const float* interleaved, float* mono, size_t numFrames, float gain = 1.0f);
+
+    // Interleaves a pair of mono buffers into one stereo buffer, as the manager does with a listener's output
+    void InterleaveStereo (const float* left, const float* right, float* interleaved, size_t numFrames);
+
+    // Samples measured side by side by MeasureLanes. A multiple of every channel count, so for interleaved
+    // audio lane l always holds channel l % numChannels.
+    constexpr int LevelLanes = 8;
+
+    // Raises peaks[i % LevelLanes] to the absolute value of samples[i] and adds its square to
+    // sums[i % LevelLanes]
+    void MeasureLanes (const float* samples, size_t numSamples, float* peaks, float* sums);
+}
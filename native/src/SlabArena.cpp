@@ -0,0 +1,41 @@
+#include "SlabArena.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace BRTSpatialiserCore
+{
+	SlabArena::SlabArena (size_t size, size_t numCellsPerSlab)
+	  : cellSize ((std::max<size_t> (size, 1) + CacheLineSize - 1) / CacheLineSize * CacheLineSize),
+	    cellsPerSlab (std::max<size_t> (numCellsPerSlab, 1))
+	{
+	}
+
+	void SlabArena::reserve (size_t numCells)
+	{
+		if (numCells > cellsLeft)
+			addSlab (numCells);
+	}
+
+	void* SlabArena::allocate()
+	{
+		if (cellsLeft == 0)
+			addSlab (cellsPerSlab);
+
+		void* cell = nextCell;
+		nextCell += cellSize;
+		--cellsLeft;
+		return cell;
+	}
+
+	void SlabArena::addSlab (size_t numCells)
+	{
+		// Whatever is left of the current slab is abandoned, it is less than a slab's worth
+		const size_t bytes = numCells * cellSize + CacheLineSize - 1;
+		slabs.emplace_back (new std::byte[bytes]);
+		storageBytes += bytes;
+
+		const std::uintptr_t address = reinterpret_cast<std::uintptr_t> (slabs.back().get());
+		nextCell = slabs.back().get() + (CacheLineSize - address % CacheLineSize) % CacheLineSize;
+		cellsLeft = numCells;
+	}
+}
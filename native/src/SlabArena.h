@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace BRTSpatialiserCore
+{
+	// Cache line size that per-source state is aligned to, so no two sources share a line
+	constexpr size_t CacheLineSize = 64;
+
+	//==========================================================================
+	// Hands out fixed size, cache line aligned cells from a few large slabs, so objects created together sit
+	// next to each other in memory and creating one after warm-up doesn't call the allocator. Cells are never
+	// given back individually: the arena is for pools that only grow, and all its memory is freed with it.
+	// Constructing and destroying objects in the cells is left to the caller.
+	//
+	// Slabs are aligned by hand rather than with aligned operator new, which older macOS targets don't have.
+	class SlabArena
+	{
+	public:
+		// cellSize is rounded up to a whole number of cache lines. A slab is allocated for cellsPerSlab cells
+		// whenever allocate runs out without a reserve.
+		SlabArena (size_t cellSize, size_t cellsPerSlab);
+
+		SlabArena (const SlabArena&) = delete;
+		SlabArena& operator= (const SlabArena&) = delete;
+
+		// Makes sure the next numCells calls to allocate take no new memory, in a single slab if possible
+		void reserve (size_t numCells);
+		// Cache line aligned memory for one cell
+		void* allocate();
+
+		size_t getCellSize() const { return cellSize; }
+		size_t getStorageBytes() const { return storageBytes; }
+
+	private:
+		void addSlab (size_t numCells);
+
+		size_t cellSize;
+		size_t cellsPerSlab;
+		std::vector<std::unique_ptr<std::byte[]>> slabs;
+		std::byte* nextCell = nullptr;
+		size_t cellsLeft = 0;
+		size_t storageBytes = 0;
+	};
+}
@@ -1,6 +1,14 @@
 
 #include "SpatialiserCore.h"
 #include "AppUtils.h"
+#include "CpuFeatures.h"
+#include "HeadPose.h"
+#include "ResourceLoader.h"
+#include "ResourceRegistry.h"
+#include "SceneSnapshot.h"
+
+// Uncomment to log every parameter set, including each entry of a batch
+//#define DEBUG_LOG_PARAMETERS
 
 namespace BRTSpatialiserCore
 {
@@ -56,6 +64,156 @@ namespace BRTSpatialiserCore
 		return spatializer->GetFloat(parameter, value);
 	}
 
+	// Applies count parameters under one lock, so the audio thread sees all of them change in the same block
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    int BRTSpatialiserSetFloats (ParameterValue* values, int count)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr || values == nullptr)
+			return 0;
+		return spatializer->SetFloats (values, count);
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    int BRTSpatialiserGetFloats (float* values, int count)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr || values == nullptr)
+			return 0;
+		return spatializer->GetFloats (values, count);
+	}
+
+	// The scene snapshot is written without the mutex, see SceneSnapshot
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    SceneBuffer* BRTSpatialiserGetSceneBuffer()
+	{
+		return SceneSnapshot::instance().getWriteBuffer();
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    SceneBuffer* BRTSpatialiserPublishScene()
+	{
+		return SceneSnapshot::instance().publish();
+	}
+
+	// Head poses are also written without the mutex, so an XR tracking callback never waits for the audio thread.
+	// Passing nullptr hands listener 0 back to Unity's listener matrix.
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    void BRTSpatialiserSetHeadPose (const HeadPose* pose)
+	{
+		if (pose == nullptr)
+			HeadPoseSlot::instance().clear();
+		else
+			HeadPoseSlot::instance().write (*pose);
+	}
+
+	// The clock HeadPose timestamps are measured on
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    double BRTSpatialiserGetHeadPoseClock()
+	{
+		return HeadPoseClock();
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    bool BRTSpatialiserGetStats (EngineStats* stats)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr || stats == nullptr)
+			return false;
+
+		const size_t idleSources = spatializer->freeSourceSlots.size();
+		*stats = spatializer->performance.getStats ((UInt32) (spatializer->sourceSlots.size() - idleSources), (UInt32) idleSources);
+		return true;
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    bool BRTSpatialiserGetQualityState (QualityState* state)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr || state == nullptr)
+			return false;
+
+		*state = spatializer->getQualityState();
+		return true;
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    UInt64 BRTSpatialiserGetTableMemory (BinaryRole role)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr || role < 0 || role >= NumBinaryRoles)
+			return 0;
+		return spatializer->tableBytes[role];
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    Handle BRTSpatialiserAddListener()
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr)
+			return InvalidHandle;
+		return spatializer->addListener();
+	}
+
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    bool BRTSpatialiserRemoveListener (Handle listenerHandle)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr)
+			return false;
+		return spatializer->removeListener (listenerHandle);
+	}
+
+	// Position and rotation as given by a Unity Transform. Listener 0 follows the AudioListener so can't be set here.
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    bool BRTSpatialiserSetListenerTransform (Handle listenerHandle, float positionX, float positionY, float positionZ,
+                                             float rotationW, float rotationX, float rotationY, float rotationZ)
+	{
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		if (spatializer == nullptr || listenerHandle == spatializer->getMainListenerHandle())
+			return false;
+
+		ListenerSlot* slot = spatializer->getListener (listenerHandle);
+		if (slot == nullptr)
+			return false;
+
+		const float scale = spatializer->scaleFactor;
+		Common::CTransform transform;
+		transform.SetPosition (Common::CVector3 (positionX * scale, positionY * scale, positionZ * scale));
+		transform.SetOrientation (Common::CQuaternion (rotationW, rotationX, rotationY, rotationZ));
+		slot->listener->SetListenerTransform (transform);
+		return true;
+	}
+
+	// Resources for a single listener are loaded with BRTSpatialiserLoadListenerBinaryAsync. This makes the listener
+	// follow listener 0 again.
+	extern "C" UNITY_AUDIODSP_EXPORT_API
+    bool BRTSpatialiserResetListenerBinary (Handle listenerHandle, BinaryRole role)
+	{
+		// Declared before the lock so the listener's own tables are freed after it is released
+		LoadedBinary replaced;
+		std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+		SpatialiserCore* spatializer = SpatialiserCore::instance();
+		return spatializer != nullptr && spatializer->resetListenerBinary (listenerHandle, role, replaced);
+	}
+
     const std::string LISTENER_ID = "listener1";
     const std::string LISTENER_HRTF_MODEL_ID = "listenerHRTF";
     const std::string LISTENER_BRIR_MODEL_ID = "listenerAmbisonicBRIR";
@@ -66,6 +224,8 @@ namespace BRTSpatialiserCore
         isLimiterEnabled (true),
         enableReverbProcessing (false)
 	{
+		tableSettings.resamplingStep = HRTFRESAMPLINGSTEP;
+
 		perSourceInitialValues[EnableHRTFInterpolation] = 1.0f;
 		perSourceInitialValues[EnableFarDistanceLPF] = 1.0f;
 		perSourceInitialValues[EnableDistanceAttenuationAnechoic] = 1.0f;
@@ -80,24 +240,445 @@ namespace BRTSpatialiserCore
         
         globalParameters.SetSampleRate (sampleRate);
         globalParameters.SetBufferSize (bufferSize);
+        performance.setDeadline ((double) bufferSize / sampleRate);
         
-        const BRTHelpers::ScopedManagerSetup sm (brtManager);
-        
-        listener = brtManager.CreateListener<BRTBase::CListener> (LISTENER_ID);
+        {
+            const BRTHelpers::ScopedManagerSetup sm (brtManager);
+            
+            listeners.push_back (createListenerSlot (0));
+            listener = listeners[0]->listener;
+            listenerHRTFModel = listeners[0]->hrtfModel;
+            listenerBRIRModel = listeners[0]->brirModel;
+        }
+
+        sourceArena = std::make_shared<SlabArena> (sizeof (SourceSlot), SourceSlabSize);
+        reserveSourceSlots (sourcePoolSize);
+
+        WriteLog (std::string ("BRT: Using ") + BRTHelpers::GetCpuLevelName (BRTHelpers::GetCpuLevel()) + " kernels");
+	}
+
+	// Distance at which BRT's distance attenuation is 0 dB
+	const float AttenuationReferenceDistance = 1.0f;
+	// Nearer than this the distance law is held, as BRT does inside the head
+	const float MinimumAttenuationDistance = 0.1f;
+
+	float DistanceLawGain (float distance, float attenuationPerDoubling)
+	{
+		distance = std::max (distance, MinimumAttenuationDistance);
+		return std::pow (10.0f, attenuationPerDoubling * std::log2 (distance / AttenuationReferenceDistance) / 20.0f);
+	}
+
+	// Idle slots stay connected to every listener so claiming and releasing them never edits the BRT graph. They
+	// are fed silence from a point away from the listener, so they add nothing to the mix.
+	static void ParkSource (SourceSlot& slot)
+	{
+		std::fill (slot.inMonoBuffer.begin(), slot.inMonoBuffer.end(), 0.0f);
+		slot.soundSource->SetBuffer (slot.inMonoBuffer);
+
+		Common::CTransform transform;
+		transform.SetPosition (Common::CVector3 (0.0f, 0.0f, 1.0f));
+		slot.soundSource->SetSourceTransform (transform);
+		slot.pushedPosition.reset();
+	}
+
+	void SourceSlotDeleter::operator() (SourceSlot* slot) const
+	{
+		// Keeps the slot's memory until it is destroyed
+		const std::shared_ptr<SlabArena> arena = std::move (slot->arena);
+		slot->~SourceSlot();
+	}
+
+	SourceSlot* SpatialiserCore::createSourceSlot()
+	{
+		SourceSlotPtr slot (new (sourceArena->allocate()) SourceSlot());
+		slot->arena = sourceArena;
+		slot->index = sourceSlots.size();
+		slot->sourceID = "SoundSource_" + std::to_string (slot->index);
+		slot->owner = this;
+		slot->inMonoBuffer.resize (globalParameters.GetBufferSize());
+
+		slot->soundSource = brtManager.CreateSoundSource<BRTSourceModel::CSourceSimpleModel> (slot->sourceID);
+		if (slot->soundSource == nullptr)
+		{
+			WriteLog ("BRT: Error creating sound source: " + slot->sourceID);
+			return nullptr;
+		}
+
+		ParkSource (*slot);
+
+		for (const auto& listenerSlot : listeners)
+		{
+			if (listenerSlot != nullptr)
+				connectSoundSource (*slot, *listenerSlot);
+		}
+
+		sourceSlots.push_back (std::move (slot));
+		// So releasing a slot or ranking the sources never allocates
+		freeSourceSlots.reserve (sourceSlots.size());
+		qualityRanking.reserve (sourceSlots.size());
+		return sourceSlots.back().get();
+	}
+
+	void SpatialiserCore::reserveSourceSlots (size_t numSlots)
+	{
+		numSlots = std::min (numSlots, MaxSourcePoolSize);
+		if (sourceSlots.size() >= numSlots)
+			return;
+
+		const BRTHelpers::ScopedManagerSetup sm (brtManager);
+
+		// The whole shortfall in one slab, so the pool stays contiguous
+		sourceArena->reserve (numSlots - sourceSlots.size());
+		while (sourceSlots.size() < numSlots)
+		{
+			SourceSlot* slot = createSourceSlot();
+			if (slot == nullptr)
+				break;
+			freeSourceSlots.push_back (slot);
+		}
+	}
+
+	SourceSlot* SpatialiserCore::claimSourceSlot()
+	{
+		SourceSlot* slot = nullptr;
+		if (! freeSourceSlots.empty())
+		{
+			slot = freeSourceSlots.back();
+			freeSourceSlots.pop_back();
+		}
+		else if (sourceSlots.size() < MaxSources)
+		{
+			WriteLog ("BRT: Source pool exhausted, creating a new source. Consider a larger pool size.");
+			const BRTHelpers::ScopedManagerSetup sm (brtManager);
+			slot = createSourceSlot();
+		}
+
+		if (slot != nullptr)
+		{
+			slot->generation = NextHandleGeneration (slot->generation);
+			slot->isClaimed = true;
+		}
+		return slot;
+	}
+
+	void SpatialiserCore::releaseSourceSlot (SourceSlot* slot)
+	{
+		assert (slot != nullptr && slot->owner == this && slot->isClaimed);
+
+		// A slot taken off the reverb stays off it until the quality controller next reassesses the sources
+		ParkSource (*slot);
+		slot->sceneUpdate = 0;
+		slot->reportedDistanceGain.store (1.0f, std::memory_order_relaxed);
+		slot->meter.reset();
+		slot->isEconomy = false;
+		slot->isClaimed = false;
+		freeSourceSlots.push_back (slot);
+	}
+
+	namespace
+	{
+		// A pose older than this means tracking has stopped, and listener 0 goes back to Unity's matrix
+		constexpr double MaxHeadPoseAge = 0.25;
+		// Longest a pose is extrapolated, as angular velocity is only a good guess for a short time
+		constexpr double MaxHeadPoseExtrapolation = 0.1;
+	}
+
+	void SpatialiserCore::applyHeadPose()
+	{
+		HeadPose pose;
+		bool isConsistent;
+		const bool hasPose = HeadPoseSlot::instance().read (pose, isConsistent);
+		if (! isConsistent)
+			return;
+
+		const double now = HeadPoseClock();
+		if (! hasPose || now - pose.timestamp > MaxHeadPoseAge)
+		{
+			if (isFollowingHeadPose)
+			{
+				isFollowingHeadPose = false;
+				// Makes the next spatialiser convert Unity's matrix again even if it hasn't changed
+				listenerMatrixScale = 0.0f;
+			}
+			return;
+		}
+
+		// The manager renders this pose straight after, in the same callback, so it is heard once the output
+		// latency has passed
+		const double playbackTime = now + headPoseOutputLatency;
+		const double dt = std::clamp (playbackTime - pose.timestamp, 0.0, MaxHeadPoseExtrapolation);
+		moveMainListener (ExtrapolateHeadPose (pose, (float) dt, scaleFactor));
+		isFollowingHeadPose = true;
+	}
+
+	void SpatialiserCore::applySceneSnapshot()
+	{
+		SceneBuffer* scene = SceneSnapshot::instance().acquire();
+		if (scene == nullptr)
+			return;
+
+		++sceneUpdate;
+		const int numSources = scene->numSources;
+
+		// The buffer is ours until the next acquire, so scale it in place one field at a time
+		for (float* field : { scene->positionX, scene->positionY, scene->positionZ })
+		{
+			for (int i = 0; i < numSources; ++i)
+				field[i] *= scaleFactor;
+		}
+
+		for (int i = 0; i < numSources; ++i)
+		{
+			SourceSlot* slot = getSourceSlot (scene->sources[i]);
+			if (slot == nullptr)
+				continue;
+
+			slot->sceneUpdate = sceneUpdate;
+			if (shouldRepositionSource (*slot))
+				moveSource (*slot, Common::CVector3 (scene->positionX[i], scene->positionY[i], scene->positionZ[i]));
+
+			if (scene->hasParameters != 0)
+			{
+				for (int p = 0; p < NumSourceParameters; ++p)
+				{
+					const float value = scene->parameters[(size_t) p * scene->capacity + i];
+					if (! std::isnan (value))
+						slot->parameters[p] = value;
+				}
+			}
+		}
+	}
+
+	SourceSlot* SpatialiserCore::getSourceSlot (Handle handle)
+	{
+		const size_t index = GetHandleIndex (handle);
+		if (index >= sourceSlots.size())
+			return nullptr;
+
+		SourceSlot* slot = sourceSlots[index].get();
+		return slot->isClaimed && slot->generation == GetHandleGeneration (handle) ? slot : nullptr;
+	}
+
+	std::unique_ptr<ListenerSlot> SpatialiserCore::createListenerSlot (size_t index)
+	{
+		// Listener 0 keeps the original IDs
+		const std::string suffix = index == 0 ? "" : "_" + std::to_string (index);
+
+		auto slot = std::make_unique<ListenerSlot>();
+		listenerGenerations[index] = NextHandleGeneration (listenerGenerations[index]);
+		slot->handle = MakeHandle (index, listenerGenerations[index]);
+		slot->id = LISTENER_ID + suffix;
+		slot->hrtfModelID = LISTENER_HRTF_MODEL_ID + suffix;
+		slot->brirModelID = LISTENER_BRIR_MODEL_ID + suffix;
+
+        slot->listener = brtManager.CreateListener<BRTBase::CListener> (slot->id);
+        if (slot->listener == nullptr)
+        {
+            WriteLog ("BRT: Error creating listener " + slot->id);
+            return nullptr;
+        }
         
-        listenerHRTFModel = brtManager.CreateListenerModel<BRTListenerModel::CListenerHRTFModel> (LISTENER_HRTF_MODEL_ID);
-        if (listenerHRTFModel == nullptr)
+        slot->hrtfModel = brtManager.CreateListenerModel<BRTListenerModel::CListenerHRTFModel> (slot->hrtfModelID);
+        if (slot->hrtfModel == nullptr)
             WriteLog ("BRT: Error creating listener model");
     
-        if (! listener->ConnectListenerModel (LISTENER_HRTF_MODEL_ID))
+        if (! slot->listener->ConnectListenerModel (slot->hrtfModelID))
             WriteLog ("BRT: Error connecting listener model");
 
-        listenerBRIRModel = brtManager.CreateListenerModel<BRTListenerModel::CListenerAmbisonicEnvironmentBRIRModel> (LISTENER_BRIR_MODEL_ID);
-        if (listenerBRIRModel == nullptr)
+        slot->brirModel = brtManager.CreateListenerModel<BRTListenerModel::CListenerAmbisonicEnvironmentBRIRModel> (slot->brirModelID);
+        if (slot->brirModel == nullptr)
             WriteLog ("BRT: Error creating listener model");
        
-        if (! listener->ConnectListenerModel (LISTENER_BRIR_MODEL_ID))
+        if (! slot->listener->ConnectListenerModel (slot->brirModelID))
             WriteLog ("BRT: Error connecting listener model");
+
+		const size_t bufferSize = (size_t) globalParameters.GetBufferSize();
+		slot->leftBuffer.resize (bufferSize);
+		slot->rightBuffer.resize (bufferSize);
+		if (index != 0)
+			slot->fifo.resize (ListenerOutputBlocks * 2 * bufferSize);
+
+		return slot;
+	}
+
+	Handle SpatialiserCore::addListener()
+	{
+		// Reuse the lowest free index
+		size_t index = 1;
+		while (index < listeners.size() && listeners[index] != nullptr)
+			++index;
+
+		if (index >= MaxListeners)
+		{
+			WriteLog ("BRT: Cannot add more than " + std::to_string (MaxListeners) + " listeners");
+			return InvalidHandle;
+		}
+
+		std::unique_ptr<ListenerSlot> slot;
+		{
+			const BRTHelpers::ScopedManagerSetup sm (brtManager);
+
+			slot = createListenerSlot (index);
+			if (slot == nullptr)
+				return InvalidHandle;
+
+			for (const auto& source : sourceSlots)
+				connectSoundSource (*source, *slot);
+		}
+
+		// A new listener starts with the same settings and resources as listener 0
+		slot->listener->SetDistanceAttenuationFactor (listener->GetDistanceAttenuationFactor());
+		slot->brirModel->SetDistanceAttenuationFactor (listenerBRIRModel->GetDistanceAttenuationFactor());
+		for (const LoadedBinary& binary : installedBinaries)
+		{
+			if (binary.succeeded)
+				installOnListener (*slot, binary);
+		}
+		if (isHRTFReducedByQuality)
+			applyQualityToListener (*slot);
+
+		WriteLog ("BRT: Added listener " + slot->id);
+
+		const Handle handle = slot->handle;
+		if (index == listeners.size())
+			listeners.push_back (std::move (slot));
+		else
+			listeners[index] = std::move (slot);
+		return handle;
+	}
+
+	bool SpatialiserCore::removeListener (Handle handle)
+	{
+		ListenerSlot* slot = handle != getMainListenerHandle() ? getListener (handle) : nullptr;
+		if (slot == nullptr)
+			return false;
+
+		{
+			const BRTHelpers::ScopedManagerSetup sm (brtManager);
+
+			for (const auto& source : sourceSlots)
+				disconnectSoundSource (*source, *slot);
+
+			slot->listener->DisconnectListenerModel (slot->hrtfModelID);
+			slot->listener->DisconnectListenerModel (slot->brirModelID);
+
+			if (! brtManager.RemoveListenerModel (slot->hrtfModelID) || ! brtManager.RemoveListenerModel (slot->brirModelID)
+			    || ! brtManager.RemoveListener (slot->id))
+				WriteLog ("BRT: Error removing listener " + slot->id);
+		}
+
+		WriteLog ("BRT: Removed listener " + slot->id);
+		listeners[GetHandleIndex (handle)].reset();
+		return true;
+	}
+
+	ListenerSlot* SpatialiserCore::getListener (Handle handle)
+	{
+		const size_t index = GetHandleIndex (handle);
+		if (index >= listeners.size() || listeners[index] == nullptr || listeners[index]->handle != handle)
+			return nullptr;
+		return listeners[index].get();
+	}
+
+	bool SpatialiserCore::connectSoundSource (const SourceSlot& source, const ListenerSlot& listener)
+	{
+		bool succeeded = true;
+		if (! listener.hrtfModel->ConnectSoundSource (source.sourceID))
+		{
+			WriteLog ("BRT: Error connecting " + source.sourceID + " to HRTF model of " + listener.id);
+			succeeded = false;
+		}
+
+		// Sources the quality level has taken off the reverb join it when they are restored
+		if (! source.isReverbCulled && ! listener.brirModel->ConnectSoundSource (source.sourceID))
+		{
+			WriteLog ("BRT: Error connecting " + source.sourceID + " to BRIR model of " + listener.id);
+			succeeded = false;
+		}
+		return succeeded;
+	}
+
+	void SpatialiserCore::disconnectSoundSource (const SourceSlot& source, const ListenerSlot& listener)
+	{
+		listener.hrtfModel->DisconnectSoundSource (source.sourceID);
+		if (! source.isReverbCulled)
+			listener.brirModel->DisconnectSoundSource (source.sourceID);
+	}
+
+	bool SpatialiserCore::installListenerBinary (ListenerSlot& slot, LoadedBinary& binary)
+	{
+		if (binary.role < 0 || binary.role >= NumBinaryRoles || ! binary.succeeded || binary.sampleRate != globalParameters.GetSampleRate())
+			return false;
+
+		if (! installOnListener (slot, binary))
+			return false;
+
+		std::swap (slot.ownBinaries[binary.role], binary);
+		return true;
+	}
+
+	bool SpatialiserCore::resetListenerBinary (Handle handle, BinaryRole role, LoadedBinary& replaced)
+	{
+		// Listener 0 is the one everything else follows
+		ListenerSlot* slot = handle != getMainListenerHandle() ? getListener (handle) : nullptr;
+		if (slot == nullptr || role < 0 || role >= NumBinaryRoles)
+			return false;
+
+		ResourceLoader::instance().supersede (role, handle);
+		slot->requestedPaths[role].clear();
+		std::swap (slot->ownBinaries[role], replaced);
+		return ! installedBinaries[role].succeeded || installOnListener (*slot, installedBinaries[role]);
+	}
+
+	void SpatialiserCore::renderListenerOutputs()
+	{
+		for (size_t i = 1; i < listeners.size(); ++i)
+		{
+			ListenerSlot* slot = listeners[i].get();
+			if (slot == nullptr)
+				continue;
+
+			slot->listener->GetBuffers (slot->leftBuffer, slot->rightBuffer);
+
+			// If nothing reads this listener the oldest block is dropped
+			const size_t numSamples = 2 * slot->leftBuffer.size();
+			const size_t capacity = slot->fifo.size();
+			if (slot->fifoNumSamples + numSamples > capacity)
+			{
+				const size_t excess = slot->fifoNumSamples + numSamples - capacity;
+				slot->fifoReadPosition = (slot->fifoReadPosition + excess) % capacity;
+				slot->fifoNumSamples -= excess;
+			}
+
+			// Written in at most two runs, either side of the end of the fifo
+			const size_t writePosition = (slot->fifoReadPosition + slot->fifoNumSamples) % capacity;
+			const size_t numFrames = slot->leftBuffer.size();
+			const size_t numFramesToEnd = std::min (numFrames, (capacity - writePosition) / 2);
+			BRTHelpers::InterleaveStereo (slot->leftBuffer.data(), slot->rightBuffer.data(), slot->fifo.data() + writePosition, numFramesToEnd);
+			BRTHelpers::InterleaveStereo (slot->leftBuffer.data() + numFramesToEnd, slot->rightBuffer.data() + numFramesToEnd,
+			                              slot->fifo.data(), numFrames - numFramesToEnd);
+			slot->fifoNumSamples += numSamples;
+		}
+	}
+
+	bool SpatialiserCore::readListenerOutput (Handle handle, float* interleaved, size_t numFrames)
+	{
+		ListenerSlot* slot = handle != getMainListenerHandle() ? getListener (handle) : nullptr;
+		const size_t numSamples = 2 * numFrames;
+
+		if (slot == nullptr || slot->fifoNumSamples < numSamples)
+		{
+			std::fill (interleaved, interleaved + numSamples, 0.0f);
+			return false;
+		}
+
+		const size_t capacity = slot->fifo.size();
+		for (size_t n = 0; n < numSamples; ++n)
+			interleaved[n] = slot->fifo[(slot->fifoReadPosition + n) % capacity];
+
+		slot->fifoReadPosition = (slot->fifoReadPosition + numSamples) % capacity;
+		slot->fifoNumSamples -= numSamples;
+		return true;
 	}
 
 
@@ -105,80 +686,485 @@ namespace BRTSpatialiserCore
 	{
 		assert(instancePtr() == this);
 		instancePtr() = nullptr;
+
+		// Effects still hold their claimed slots, they delete them when released
+		for (auto& slot : sourceSlots)
+		{
+			if (slot->isClaimed)
+			{
+				slot->owner = nullptr;
+				slot.release();
+			}
+		}
 	}
 
 	bool SpatialiserCore::loadBinary (BinaryRole role, std::string path)
+	{
+		// A synchronous load replaces anything still in flight for this role
+		ResourceLoader::instance().supersede (role);
+		requestedPaths[role] = path;
+
+		LoadedBinary binary = readBinary (role, path, tableSettings);
+		const std::string description = describeBinary (binary);
+		const bool isInstalled = installBinary (binary);
+		WriteLog ((isInstalled ? "BRT: Installed " : "BRT: Could not install ") + description);
+		return isInstalled;
+	}
+
+	LoadedBinary SpatialiserCore::readBinary (BinaryRole role, std::string path, const TableSettings& settings, std::atomic<float>* progress)
 	{
 		const std::string sofaExtension = ".sofa";
 		const bool hasSofaExtension = path.size() >= sofaExtension.size() && path.substr(path.size() - sofaExtension.size()) == sofaExtension;
 
         WriteLog ("BRT: Loading binary of role " + std::to_string (role) + " : " + path);
-        
+
+		LoadedBinary binary;
+		binary.role = role;
+		binary.path = path;
+		binary.sampleRate = Common::CGlobalParameters().GetSampleRate();
+		binary.settings = settings;
+		const int resamplingStep = settings.resamplingStep;
+		const int bufferSize = Common::CGlobalParameters().GetBufferSize();
+
+		if (progress != nullptr)
+			progress->store (0.0f);
+
+		// Tables already loaded by anyone in this process are shared rather than read again
+		ResourceRegistry& registry = ResourceRegistry::instance();
+		ResourceKey key;
+		key.contentHash = HashFileContents (path);
+		key.sampleRate = binary.sampleRate;
+		key.role = role;
+
 		switch (role)
 		{
 		case HighQualityHRTF:
 			if (hasSofaExtension)
 			{
 				// We assume an ILD file holds the delays, so our SOFA file does not specify delays
-				// bool specifiedDelays = false;
-				// isBinaryResourceLoaded[HighQualityHRTF] = HRTF::CreateFromSofa(path, listener, specifiedDelays);
-                // Load HRTF
-                auto hrtf = std::make_shared<BRTServices::CHRTF>();
-                bool sofaHRTFLoaded = AppUtils::LoadHRTFSofaFile (path, hrtf);
-                // Set one for the listener. We can change it at runtime
-                if (sofaHRTFLoaded)
+                // The raw measurements are only read while a table is built from them and freed straight after. The
+                // table is interpolated from the measurements as stored, so it depends on their format too.
+                key.storageFormat = (int) settings.storageFormat;
+                key.resamplingStep = resamplingStep;
+                key.headRadius = settings.hrtfSettings.headRadius.value_or (-1.0f);
+                key.customITD = settings.hrtfSettings.isCustomITDEnabled.has_value() ? (int) *settings.hrtfSettings.isCustomITDEnabled : -1;
+                binary.hrtf = registry.acquire<BRTServices::CHRTF> (key, [&]
                 {
-                    WriteLog ("BRT: SOFA HRTF loaded. Setting on listener");
-                    isBinaryResourceLoaded[HighQualityHRTF] = listener->SetHRTF (hrtf);
-                }
+                    auto hrtf = std::make_shared<BRTServices::CHRTF>();
+                    const std::unique_ptr<HRIRMeasurementSet> measurements = HRIRMeasurementSet::load (path, settings.storageFormat);
+                    if (! AppUtils::LoadHRTFSofaFile (path, hrtf, resamplingStep, measurements.get(), progress))
+                        return std::shared_ptr<BRTServices::CHRTF>();
+
+                    ApplyHRTFSettings (settings.hrtfSettings, *hrtf);
+                    return hrtf;
+                });
+                binary.succeeded = binary.hrtf != nullptr;
+                if (binary.succeeded)
+                    binary.tableBytes = EstimateTableBytes (resamplingStep, binary.hrtf->GetHRIRLength(), bufferSize);
 			}
 			else // If not sofa file then assume its a 3dti-hrtf file
 			{
-				// isBinaryResourceLoaded[HighQualityHRTF] = HRTF::CreateFrom3dti(path, listener);
+				// binary.succeeded = HRTF::CreateFrom3dti(path, listener);
 			}
-			return isBinaryResourceLoaded[HighQualityHRTF];
+			break;
 		case HighQualityILD:
             {
-                // isBinaryResourceLoaded[HighQualityILD] = ILD::CreateFrom3dti_ILDNearFieldEffectTable(path, listener);
-                auto sosFilter = std::make_shared<BRTServices::CSOSFilters>();
-                bool nearFieldFilterLoaded = AppUtils::LoadNearFieldSOSFilter (path, sosFilter);
-                
-                if (nearFieldFilterLoaded)
+                binary.sosFilter = registry.acquire<BRTServices::CSOSFilters> (key, [&]
                 {
-                    WriteLog ("BRT: SOFA NEAR FIELD ILD loaded. Setting on listener");
-                    isBinaryResourceLoaded[HighQualityILD] = listener->SetNearFieldCompensationFilters (sosFilter);
-                }
-                
-                return isBinaryResourceLoaded[HighQualityILD];
+                    auto sosFilter = std::make_shared<BRTServices::CSOSFilters>();
+                    return AppUtils::LoadNearFieldSOSFilter (path, sosFilter) ? sosFilter : nullptr;
+                });
+                binary.succeeded = binary.sosFilter != nullptr;
+                break;
             }
 		case HighPerformanceILD:
-			// isBinaryResourceLoaded[HighPerformanceILD] = ILD::CreateFrom3dti_ILDSpatializationTable(path, listener);
-			return isBinaryResourceLoaded[HighPerformanceILD];
+			// binary.succeeded = ILD::CreateFrom3dti_ILDSpatializationTable(path, listener);
+			break;
 		case ReverbBRIR:
 			if (hasSofaExtension)
 			{
-                // Load BRIR
-                auto brir = std::make_shared<BRTServices::CHRBRIR>();
-                bool brirSofaLoaded = AppUtils::LoadBRIRSofaFile (path, brir, 0,0,0,0);
-                if (brirSofaLoaded) {
-                    WriteLog ("BRT: SOFA BRIR loaded. Setting on listener");
-                    isBinaryResourceLoaded[ReverbBRIR] = listener->SetHRBRIR (brir);
-                }
+                key.resamplingStep = resamplingStep;
+                binary.brir = registry.acquire<BRTServices::CHRBRIR> (key, [&]
+                {
+                    auto brir = std::make_shared<BRTServices::CHRBRIR>();
+                    return AppUtils::LoadBRIRSofaFile (path, brir, resamplingStep, 0,0,0,0) ? brir : nullptr;
+                });
+                binary.succeeded = binary.brir != nullptr;
+                if (binary.succeeded)
+                    binary.tableBytes = EstimateTableBytes (resamplingStep, binary.brir->GetHRIRLength(), bufferSize);
 			}
 			else
 			{
                 // If not sofa file then assume its a 3dti-hrtf file
-				// isBinaryResourceLoaded[ReverbBRIR] = BRIR::CreateFrom3dti(path, environment);
+				// binary.succeeded = BRIR::CreateFrom3dti(path, environment);
 			}
-			return isBinaryResourceLoaded[ReverbBRIR];
+			break;
+		default:
+			break;
+		}
+
+		if (progress != nullptr)
+			progress->store (1.0f);
+
+		return binary;
+	}
+
+	std::string SpatialiserCore::describeBinary (const LoadedBinary& binary)
+	{
+		std::string description = "binary of role " + std::to_string (binary.role) + " from " + binary.path
+		                          + " at sample rate " + std::to_string (binary.sampleRate);
+
+		if (! binary.succeeded)
+			return description;
+
+		if (binary.tableBytes > 0)
+			description += ", table at " + std::to_string (binary.settings.resamplingStep) + " degree resampling step uses about "
+			               + std::to_string (binary.tableBytes / 1024) + " KB";
+		return description;
+	}
+
+	bool SpatialiserCore::installBinary (LoadedBinary& binary)
+	{
+		if (binary.role < 0 || binary.role >= NumBinaryRoles)
+			return false;
+
+		// On failure whatever was loaded before stays on the listener
+		if (! binary.succeeded || binary.sampleRate != globalParameters.GetSampleRate())
+			return false;
+
+		isBinaryResourceLoaded[binary.role] = installOnListener (*listeners[0], binary);
+		if (! isBinaryResourceLoaded[binary.role])
+			return false;
+
+		for (size_t i = 1; i < listeners.size(); ++i)
+		{
+			if (listeners[i] != nullptr && ! listeners[i]->ownBinaries[binary.role].succeeded)
+				installOnListener (*listeners[i], binary);
+		}
+
+		tableBytes[binary.role] = binary.tableBytes;
+		std::swap (installedBinaries[binary.role], binary);
+		return true;
+	}
+
+	bool SpatialiserCore::installOnListener (ListenerSlot& slot, const LoadedBinary& binary)
+	{
+		switch (binary.role)
+		{
+		case HighQualityHRTF:
+			return slot.listener->SetHRTF (binary.hrtf);
+		case HighQualityILD:
+			return slot.listener->SetNearFieldCompensationFilters (binary.sosFilter);
+		case ReverbBRIR:
+			return slot.listener->SetHRBRIR (binary.brir);
 		default:
 			return false;
 		}
 	}
 
+	void SpatialiserCore::reloadTables (std::initializer_list<BinaryRole> roles)
+	{
+		ResourceLoader& loader = ResourceLoader::instance();
+
+		for (BinaryRole role : roles)
+		{
+			if (isApplyingBatch)
+			{
+				batchReloads[role] = true;
+				continue;
+			}
+
+			if (! requestedPaths[role].empty())
+				loader.enqueue (role, requestedPaths[role], tableSettings);
+
+			for (size_t i = 1; i < listeners.size(); ++i)
+			{
+				if (listeners[i] != nullptr && ! listeners[i]->requestedPaths[role].empty())
+					loader.enqueue (role, listeners[i]->requestedPaths[role], tableSettings, listeners[i]->handle);
+			}
+		}
+	}
+
+	int SpatialiserCore::SetFloats (ParameterValue* values, int count)
+	{
+		isApplyingBatch = true;
+		int numSet = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (SetFloat (values[i].parameter, values[i].value))
+				++numSet;
+			// Parameters are clamped or rounded as they are set, so the caller needs no second call to read them back
+			GetFloat (values[i].parameter, &values[i].value);
+		}
+		isApplyingBatch = false;
+
+		for (int role = 0; role < NumBinaryRoles; ++role)
+		{
+			if (batchReloads[role])
+			{
+				batchReloads[role] = false;
+				reloadTables ({ (BinaryRole) role });
+			}
+		}
+		return numSet;
+	}
+
+	int SpatialiserCore::GetFloats (float* values, int count)
+	{
+		int numRead = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			values[i] = std::numeric_limits<float>::quiet_NaN();
+			if (GetFloat (i, &values[i]))
+				++numRead;
+		}
+		return numRead;
+	}
+
+	void SpatialiserCore::applyPendingBinaries()
+	{
+		ResourceLoader& loader = ResourceLoader::instance();
+
+		for (int role = 0; role < NumBinaryRoles; ++role)
+		{
+			// The job's worker frees whatever the install swapped out, and logs it
+			if (LoadJob* job = loader.takePending ((BinaryRole) role))
+				job->status = installBinary (job->result) ? LoadCompleted : LoadFailed;
+
+			// Resources for a single listener fail if it was removed while they were read
+			for (size_t i = 1; i < listeners.size(); ++i)
+			{
+				if (LoadJob* job = loader.takePending ((BinaryRole) role, i))
+				{
+					ListenerSlot* slot = getListener (job->listener);
+					job->status = slot != nullptr && installListenerBinary (*slot, job->result) ? LoadCompleted : LoadFailed;
+				}
+			}
+		}
+	}
+
+	namespace
+	{
+		// Degrees between two directions
+		float AngleBetween (const Common::CVector3& a, const Common::CVector3& b)
+		{
+			const Common::CVector3 cross (a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+			return std::atan2 (cross.GetDistance(), a.x * b.x + a.y * b.y + a.z * b.z) * 180.0f / kPI;
+		}
+
+		// Degrees of the rotation from one orientation to the other
+		float AngleBetween (const Common::CQuaternion& a, const Common::CQuaternion& b)
+		{
+			const float dot = std::fabs (a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+			return 2.0f * std::acos (std::min (dot, 1.0f)) * 180.0f / kPI;
+		}
+	}
+
+	bool SpatialiserCore::hasListenerMatrixChanged (const float* matrix)
+	{
+		if (std::equal (listenerMatrix.begin(), listenerMatrix.end(), matrix) && listenerMatrixScale == scaleFactor)
+			return false;
+
+		std::copy (matrix, matrix + listenerMatrix.size(), listenerMatrix.begin());
+		listenerMatrixScale = scaleFactor;
+		return true;
+	}
+
+	void SpatialiserCore::moveMainListener (const Common::CTransform& transform)
+	{
+		const Common::CVector3 from = mainListenerPose.GetPosition();
+		const Common::CVector3 to = transform.GetPosition();
+		const Common::CVector3 offset (to.x - from.x, to.y - from.y, to.z - from.z);
+		if (listenerPoseUpdate != 0 && offset.GetDistance() <= poseTolerance.distance
+		    && AngleBetween (mainListenerPose.GetOrientation(), transform.GetOrientation()) <= poseTolerance.angle)
+			return;
+
+		listener->SetListenerTransform (transform);
+		mainListenerPose = transform;
+		++listenerPoseUpdate;
+	}
+
+	void SpatialiserCore::moveSource (SourceSlot& slot, const Common::CVector3& position)
+	{
+		// Everything is compared in the frame of the listener pose BRT has
+		Common::CTransform transform;
+		transform.SetPosition (position);
+		const Common::CVector3 local = mainListenerPose.GetVectorTo (transform);
+		slot.listenerDistance = local.GetDistance();
+
+		const auto isWithinTolerance = [this] (const Common::CVector3& a, const Common::CVector3& b)
+		{
+			return std::fabs (a.GetDistance() - b.GetDistance()) <= poseTolerance.distance && AngleBetween (a, b) <= poseTolerance.angle;
+		};
+
+		if (slot.pushedPosition.has_value())
+		{
+			// A source that stays put in the world: BRT already has its position. If the listener has moved
+			// since, BRT hears it from a new direction.
+			Common::CTransform pushed;
+			pushed.SetPosition (*slot.pushedPosition);
+			const Common::CVector3 pushedLocal = slot.listenerPoseUpdate == listenerPoseUpdate ? slot.pushedLocalPosition
+			                                                                                  : mainListenerPose.GetVectorTo (pushed);
+			if (isWithinTolerance (local, pushedLocal))
+			{
+				if (slot.listenerPoseUpdate != listenerPoseUpdate)
+				{
+					slot.pushedLocalPosition = pushedLocal;
+					slot.listenerPoseUpdate = listenerPoseUpdate;
+				}
+				return;
+			}
+
+			// A source that moves with the listener, such as UI or voice-over, keeps the position relative to the
+			// listener it was last set with. It is carried along to the listener's new pose so the direction
+			// BRT hears it from is exactly the same and nothing has to be looked up again.
+			if (slot.listenerPoseUpdate != listenerPoseUpdate && isWithinTolerance (local, slot.pushedLocalPosition))
+			{
+				const Common::CVector3 origin = mainListenerPose.GetPosition();
+				const Common::CVector3 rotated = mainListenerPose.GetOrientation().RotateVector (slot.pushedLocalPosition);
+				const Common::CVector3 carried (origin.x + rotated.x, origin.y + rotated.y, origin.z + rotated.z);
+				Common::CTransform carriedTransform;
+				carriedTransform.SetPosition (carried);
+				slot.soundSource->SetSourceTransform (carriedTransform);
+				slot.pushedPosition = carried;
+				slot.listenerPoseUpdate = listenerPoseUpdate;
+				return;
+			}
+		}
+
+		slot.soundSource->SetSourceTransform (transform);
+		slot.pushedPosition = position;
+		slot.pushedLocalPosition = local;
+		slot.listenerPoseUpdate = listenerPoseUpdate;
+	}
+
+	// Sources move, so while quality is reduced which of them each reduction applies to is reassessed this often
+	const UInt32 QualityReassessBlocks = 64;
+	// Economy sources are repositioned on one block in this many, staggered across sources
+	const UInt32 EconomyRepositionBlocks = 4;
+	// A source taken off the reverb only rejoins it once it is this much nearer than reverbDistance
+	const float ReverbRestoreMargin = 0.9f;
+
+	bool SpatialiserCore::shouldRepositionSource (const SourceSlot& slot) const
+	{
+		return ! slot.isEconomy || (quality.getBlockCount() + (UInt32) slot.index) % EconomyRepositionBlocks == 0;
+	}
+
+	void SpatialiserCore::updateQuality()
+	{
+		const bool hasChanged = quality.update (performance.getLastBlockTime(), performance.getDeadline());
+		if (hasChanged)
+			WriteLog ("BRT: Quality level " + std::to_string ((int) quality.getLevel()));
+
+		if (hasChanged || (quality.getLevel() != QualityFull && quality.getBlockCount() % QualityReassessBlocks == 0))
+			applyQualityLevel();
+	}
+
+	void SpatialiserCore::applyQualityLevel()
+	{
+		const QualityLevel level = quality.getLevel();
+		const QualitySettings& settings = quality.settings;
+
+		const bool shouldReduceHRTF = level >= QualityNoInterpolation;
+		if (shouldReduceHRTF != isHRTFReducedByQuality)
+		{
+			isHRTFReducedByQuality = shouldReduceHRTF;
+			for (const auto& slot : listeners)
+			{
+				if (slot != nullptr)
+					applyQualityToListener (*slot);
+			}
+		}
+
+		// The furthest sources are the first to go to economy
+		qualityRanking.clear();
+		for (const auto& slot : sourceSlots)
+		{
+			if (slot->isClaimed)
+				qualityRanking.push_back (slot.get());
+		}
+		const float economyShare = level >= QualityEconomy ? std::clamp (settings.economyShare, 0.0f, 1.0f) : 0.0f;
+		const auto numEconomy = (std::ptrdiff_t) std::lround (economyShare * qualityRanking.size());
+		std::nth_element (qualityRanking.begin(), qualityRanking.begin() + numEconomy, qualityRanking.end(),
+		                  [] (const SourceSlot* a, const SourceSlot* b) { return a->listenerDistance > b->listenerDistance; });
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t) qualityRanking.size(); ++i)
+			qualityRanking[i]->isEconomy = i < numEconomy;
+
+		// Taking a source off the reverb edits the BRT graph, so the setup is only entered if something changes
+		auto shouldCullReverb = [&] (const SourceSlot& slot)
+		{
+			if (level < QualityNoDistantReverb || ! slot.isClaimed)
+				return false;
+			const float distance = slot.isReverbCulled ? settings.reverbDistance * ReverbRestoreMargin : settings.reverbDistance;
+			return slot.listenerDistance > distance;
+		};
+
+		const bool hasReverbChanges = std::any_of (sourceSlots.begin(), sourceSlots.end(), [&] (const auto& slot)
+		{
+			return shouldCullReverb (*slot) != slot->isReverbCulled;
+		});
+		if (! hasReverbChanges)
+			return;
+
+		const BRTHelpers::ScopedManagerSetup sm (brtManager);
+		for (const auto& source : sourceSlots)
+		{
+			// Idle sources are never culled, so one released while culled rejoins the reverb here
+			const bool isCulled = shouldCullReverb (*source);
+			if (isCulled == source->isReverbCulled)
+				continue;
+
+			source->isReverbCulled = isCulled;
+			for (const auto& slot : listeners)
+			{
+				if (slot == nullptr)
+					continue;
+				if (isCulled)
+					slot->brirModel->DisconnectSoundSource (source->sourceID);
+				else
+					slot->brirModel->ConnectSoundSource (source->sourceID);
+			}
+		}
+	}
+
+	void SpatialiserCore::applyQualityToListener (ListenerSlot& slot)
+	{
+		if (slot.isHRTFReducedByQuality == isHRTFReducedByQuality)
+			return;
+		slot.isHRTFReducedByQuality = isHRTFReducedByQuality;
+
+		if (isHRTFReducedByQuality)
+		{
+			slot.wasInterpolationEnabled = slot.hrtfModel->IsInterpolationEnabled();
+			slot.wasNearFieldEffectEnabled = slot.hrtfModel->IsNearFieldEffectEnabled();
+			slot.hrtfModel->DisableInterpolation();
+			slot.hrtfModel->DisableNearFieldEffect();
+		}
+		else
+		{
+			if (slot.wasInterpolationEnabled)
+				slot.hrtfModel->EnableInterpolation();
+			if (slot.wasNearFieldEffectEnabled)
+				slot.hrtfModel->EnableNearFieldEffect();
+		}
+	}
+
+	QualityState SpatialiserCore::getQualityState() const
+	{
+		QualityState state = quality.getState();
+		for (const auto& slot : sourceSlots)
+		{
+			state.sourcesWithoutReverb += slot->isReverbCulled ? 1 : 0;
+			state.economySources += slot->isEconomy ? 1 : 0;
+		}
+		return state;
+	}
+
 	bool SpatialiserCore::SetFloat(int parameter, float value)
 	{
+#ifdef DEBUG_LOG_PARAMETERS
         WriteLog ("BRT: Setting parameter " + std::to_string (parameter) + " : " + std::to_string (value));
+#endif
         
 		switch (parameter)
 		{
@@ -196,8 +1182,13 @@ namespace BRTSpatialiserCore
 		{
 			const float min = 0.0f;
 			const float max = 1e20f;
-            if (auto hrtf = listener->GetHRTF())
-                hrtf->SetHeadRadius (std::clamp (value, min, max));
+			const float newRadius = std::clamp (value, min, max);
+			// BRT keeps the head radius on the HRTF table, which may be shared, so a table with the new one is built
+			if (tableSettings.hrtfSettings.headRadius != newRadius)
+			{
+				tableSettings.hrtfSettings.headRadius = newRadius;
+				reloadTables ({ HighQualityHRTF });
+			}
 			return true;
 		}
 		case ScaleFactor:
@@ -209,24 +1200,23 @@ namespace BRTSpatialiserCore
 		}
 		case EnableCustomITD:
 		{
-            if (auto hrtf = listener->GetHRTF())
-            {
-                if (value == 0.0f)
-                {
-                    hrtf->DisableWoodworthITD();
-                }
-                else
-                {
-                    hrtf->EnableWoodworthITD();
-                }
-            }
+			const bool isEnabled = value != 0.0f;
+			if (tableSettings.hrtfSettings.isCustomITDEnabled != isEnabled)
+			{
+				tableSettings.hrtfSettings.isCustomITDEnabled = isEnabled;
+				reloadTables ({ HighQualityHRTF });
+			}
 			return true;
 		}
 		case AnechoicDistanceAttenuation:
 		{
 			const float min = -30.0f;
 			const float max = 0.0f;
-            listener->SetDistanceAttenuationFactor (std::clamp (value, min, max));
+            for (const auto& slot : listeners)
+            {
+                if (slot != nullptr)
+                    slot->listener->SetDistanceAttenuationFactor (std::clamp (value, min, max));
+            }
             return true;
 		}
 		case ILDAttenuation:
@@ -287,7 +1277,13 @@ namespace BRTSpatialiserCore
 		{
 			const float min = 1.0f;
 			const float max = 90.0f;
-			// core.SetHRTFResamplingStep((int)clamp(value, min, max));
+			const int step = (int) std::lround (std::clamp (value, min, max));
+			if (step != tableSettings.resamplingStep)
+			{
+				tableSettings.resamplingStep = step;
+				// The tables are rebuilt in the background and the current ones keep playing until then
+				reloadTables ({ HighQualityHRTF, ReverbBRIR });
+			}
 			return true;
 		}
 		case EnableReverbProcessing:
@@ -316,9 +1312,63 @@ namespace BRTSpatialiserCore
 		{
 			const float min = -90.0f;
 			const float max = 0.0f;
-            listenerBRIRModel->SetDistanceAttenuationFactor (std::clamp (value, min, max));
+            for (const auto& slot : listeners)
+            {
+                if (slot != nullptr)
+                    slot->brirModel->SetDistanceAttenuationFactor (std::clamp (value, min, max));
+            }
+			return true;
+		}
+		case HRIRStorageFormat:
+		{
+			const float min = (float) BRTHelpers::SampleFormat::Float32;
+			const float max = (float) BRTHelpers::SampleFormat::BFloat16;
+			const auto format = (BRTHelpers::SampleFormat) std::lround (std::clamp (value, min, max));
+			if (format != tableSettings.storageFormat)
+			{
+				tableSettings.storageFormat = format;
+				reloadTables ({ HighQualityHRTF });
+			}
 			return true;
 		}
+		case SourcePoolSize:
+		{
+			sourcePoolSize = (size_t) std::lround (std::clamp (value, 0.0f, (float) MaxSourcePoolSize));
+			reserveSourceSlots (sourcePoolSize);
+			return true;
+		}
+		// The controller picks these up on the next block
+		case EnableAdaptiveQuality:
+			quality.settings.isEnabled = value != 0.0f;
+			return true;
+		case AdaptiveQualityMaxLevel:
+			quality.settings.maxLevel = (int) std::lround (std::clamp (value, (float) QualityFull, (float) QualityEconomy));
+			return true;
+		case AdaptiveQualityDegradeLoad:
+			quality.settings.degradeLoad = std::clamp (value, 0.1f, 2.0f);
+			return true;
+		case AdaptiveQualityRestoreLoad:
+			quality.settings.restoreLoad = std::clamp (value, 0.0f, 2.0f);
+			return true;
+		case AdaptiveQualityRestoreTime:
+			quality.settings.restoreTime = std::clamp (value, 0.0f, 600.0f);
+			return true;
+		case AdaptiveQualityReverbDistance:
+			quality.settings.reverbDistance = std::clamp (value, 0.0f, 1e20f);
+			return true;
+		case AdaptiveQualityEconomyShare:
+			quality.settings.economyShare = std::clamp (value, 0.0f, 1.0f);
+			return true;
+		// Poses already on BRT stay until they next move beyond the new tolerance
+		case PoseAngleTolerance:
+			poseTolerance.angle = std::clamp (value, 0.0f, 180.0f);
+			return true;
+		case PoseDistanceTolerance:
+			poseTolerance.distance = std::max (value, 0.0f);
+			return true;
+		case HeadPoseOutputLatency:
+			headPoseOutputLatency = std::clamp (value, 0.0f, 0.2f);
+			return true;
 		default:
 			return false;
 		}
@@ -344,14 +1394,19 @@ namespace BRTSpatialiserCore
 			*value = perSourceInitialValues[parameter];
 			return true;
 		case HeadRadius:
-            if (auto hrtf = listener->GetHRTF())
+			// The table with a newly set value may still be building
+            if (tableSettings.hrtfSettings.headRadius.has_value())
+                *value = *tableSettings.hrtfSettings.headRadius;
+            else if (auto hrtf = listener->GetHRTF())
                 *value = hrtf->GetHeadRadius();
 			return true;
 		case ScaleFactor:
 			*value = scaleFactor;
 			return true;
 		case EnableCustomITD:
-            if (auto hrtf = listener->GetHRTF())
+            if (tableSettings.hrtfSettings.isCustomITDEnabled.has_value())
+                *value = *tableSettings.hrtfSettings.isCustomITDEnabled ? 1.0f : 0.0f;
+            else if (auto hrtf = listener->GetHRTF())
                 *value = listener->GetHRTF()->IsWoodworthITDEnabled() ? 1.0f : 0.0f;
 			return true;
 		case AnechoicDistanceAttenuation:
@@ -379,8 +1434,8 @@ namespace BRTSpatialiserCore
 			*value = isLimiterEnabled ? 1.0f : 0.0f;
 			return true;
 		case HRTFResamplingStep:
-            // *value = (float)HRTFResamplingStep;
-			// return true;
+			*value = (float) tableSettings.resamplingStep;
+			return true;
 		case EnableReverbProcessing:
 			*value = (float) enableReverbProcessing;
 			return true;
@@ -391,6 +1446,42 @@ namespace BRTSpatialiserCore
             *value = listenerBRIRModel->GetDistanceAttenuationFactor();
 			// *value = core.GetMagnitudes().GetReverbDistanceAttenuation();
             return true;
+		case HRIRStorageFormat:
+			*value = (float) tableSettings.storageFormat;
+			return true;
+		case SourcePoolSize:
+			*value = (float) sourcePoolSize;
+			return true;
+		case EnableAdaptiveQuality:
+			*value = quality.settings.isEnabled ? 1.0f : 0.0f;
+			return true;
+		case AdaptiveQualityMaxLevel:
+			*value = (float) quality.settings.maxLevel;
+			return true;
+		case AdaptiveQualityDegradeLoad:
+			*value = quality.settings.degradeLoad;
+			return true;
+		case AdaptiveQualityRestoreLoad:
+			*value = quality.settings.restoreLoad;
+			return true;
+		case AdaptiveQualityRestoreTime:
+			*value = quality.settings.restoreTime;
+			return true;
+		case AdaptiveQualityReverbDistance:
+			*value = quality.settings.reverbDistance;
+			return true;
+		case AdaptiveQualityEconomyShare:
+			*value = quality.settings.economyShare;
+			return true;
+		case PoseAngleTolerance:
+			*value = poseTolerance.angle;
+			return true;
+		case PoseDistanceTolerance:
+			*value = poseTolerance.distance;
+			return true;
+		case HeadPoseOutputLatency:
+			*value = headPoseOutputLatency;
+			return true;
 		default:
 			*value = std::numeric_limits<float>::quiet_NaN();
 			return false;
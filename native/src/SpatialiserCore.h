@@ -1,10 +1,18 @@
 #pragma once
 
 #define NOMINMAX
+#include <atomic>
 #include <cfloat>
+#include <optional>
 #include "AudioPluginUtil.h"
 #include "AudioPluginInterface.h"
+#include "SimdKernels.h"
 #include "BRTLibrary.h"
+#include "HRTFResampler.h"
+#include "Meter.h"
+#include "PerformanceMonitor.h"
+#include "QualityController.h"
+#include "SlabArena.h"
 
 namespace BRTHelpers
 {
@@ -30,6 +38,7 @@ inline void WriteLog (std::string logText)
 
 namespace BRTSpatialiserCore
 {
+
 	// Parameters set outside of the unity Parameter system
 	enum FloatParameter : int
 	{
@@ -64,8 +73,20 @@ namespace BRTSpatialiserCore
 		EnableReverbProcessing = 19,
 		ReverbOrder = 20,
 		ReverbDistanceAttenuation = 21,
+		HRIRStorageFormat = 22,
+		SourcePoolSize = 23,
+		EnableAdaptiveQuality = 24,
+		AdaptiveQualityMaxLevel = 25,
+		AdaptiveQualityDegradeLoad = 26,
+		AdaptiveQualityRestoreLoad = 27,
+		AdaptiveQualityRestoreTime = 28,
+		AdaptiveQualityReverbDistance = 29,
+		AdaptiveQualityEconomyShare = 30,
+		PoseAngleTolerance = 31,
+		PoseDistanceTolerance = 32,
+		HeadPoseOutputLatency = 33,
 
-		NumFloatParameters = 22,
+		NumFloatParameters = 34,
 	};
 
 
@@ -79,6 +100,150 @@ namespace BRTSpatialiserCore
 		NumBinaryRoles = 4,
 	};
 
+	// Identifies a source or listener across the C# boundary. The low bits index a dense array in the core, the
+	// high bits are a generation bumped every time that entry is reused, so a stale handle is rejected instead of
+	// reaching whoever took its place. Small enough to be held exactly in a float, as Unity parameters are.
+	using Handle = UInt32;
+	constexpr int HandleIndexBits = 16;
+	constexpr UInt32 MaxHandleGeneration = 0xff;
+	constexpr Handle InvalidHandle = 0;  // Generations start at 1, so no valid handle is 0
+	static_assert ((((UInt64) MaxHandleGeneration + 1) << HandleIndexBits) <= (1u << 24), "Handles must be exactly representable as a float");
+
+	inline Handle MakeHandle (size_t index, UInt32 generation)     { return (generation << HandleIndexBits) | (Handle) index; }
+	inline size_t GetHandleIndex (Handle handle)                   { return handle & ((1u << HandleIndexBits) - 1); }
+	inline UInt32 GetHandleGeneration (Handle handle)              { return handle >> HandleIndexBits; }
+	inline UInt32 NextHandleGeneration (UInt32 generation)         { return generation % MaxHandleGeneration + 1; }
+
+	// One entry of a batched parameter update. Layout must be kept in sync with the c# struct.
+	struct ParameterValue
+	{
+		int parameter;
+		float value;
+	};
+
+	// Settings that change how a table is built from its file
+	struct TableSettings
+	{
+		int resamplingStep = 0;
+		// Format the raw HRIRs are held in while a table is interpolated from them. BRT's tables are always 32 bit float.
+		BRTHelpers::SampleFormat storageFormat = BRTHelpers::SampleFormat::Float32;
+		HRTFSettings hrtfSettings;
+	};
+
+	// The result of parsing a binary resource file. It holds no reference to a SpatialiserCore so it can be
+	// built on any thread and installed later with SpatialiserCore::installBinary.
+	struct LoadedBinary
+	{
+		BinaryRole role = NumBinaryRoles;
+		std::string path;
+		UInt32 sampleRate = 0;
+		TableSettings settings;
+		bool succeeded = false;
+		size_t tableBytes = 0;  // Estimated memory used by the table
+		std::shared_ptr<BRTServices::CHRTF> hrtf;
+		std::shared_ptr<BRTServices::CHRBRIR> brir;
+		std::shared_ptr<BRTServices::CSOSFilters> sosFilter;
+	};
+
+	// One listener of the scene, with its own pose, models and resources. Listener 0 is driven by Unity's
+	// AudioListener and its output is returned by the manager effect. Other listeners hear the same sources
+	// and are read through the BRT Listener Output effect.
+	struct ListenerSlot
+	{
+		std::string id;
+		std::string hrtfModelID;
+		std::string brirModelID;
+		std::shared_ptr<BRTBase::CListener> listener;
+		std::shared_ptr<BRTListenerModel::CListenerHRTFModel> hrtfModel;
+		std::shared_ptr<BRTListenerModel::CListenerAmbisonicEnvironmentBRIRModel> brirModel;
+		// Resources loaded for this listener alone. Roles whose binary has not succeeded follow listener 0.
+		std::array<LoadedBinary, NumBinaryRoles> ownBinaries;
+		// The most recently requested path for each role loaded for this listener alone, empty for the others
+		std::array<std::string, NumBinaryRoles> requestedPaths;
+		Handle handle = InvalidHandle;
+		// Whether the HRTF model had interpolation and near field filters on before adaptive quality turned them off,
+		// so restoring quality puts back what was there rather than forcing them on
+		bool isHRTFReducedByQuality = false;
+		bool wasInterpolationEnabled = true;
+		bool wasNearFieldEffectEnabled = true;
+
+		CMonoBuffer<float> leftBuffer;
+		CMonoBuffer<float> rightBuffer;
+		// Interleaved stereo rendered by the manager and not yet read by an output effect
+		std::vector<float> fifo;
+		size_t fifoReadPosition = 0;
+		size_t fifoNumSamples = 0;
+	};
+
+	// How far a pose may move before it is passed on to BRT. Both apply to a source as seen from the listener, so a
+	// distant source can drift further than a near one, and to the listener's own position and orientation.
+	struct PoseTolerance
+	{
+		float angle = 0.5f;      // Degrees
+		float distance = 0.01f;  // Metres
+	};
+
+	// Broadband gain of BRT's distance law for a source distance metres from the listener. The near field filters
+	// are left out as they shape the spectrum of the nearer ear rather than its level. Cheap enough for Unity's
+	// distance attenuation callback.
+	float DistanceLawGain (float distance, float attenuationPerDoubling);
+	// Most the input is boosted by to take the reported distance law back off, so a distant source or a steep
+	// attenuation factor can't blow the input up. Only sources already 60 dB down are affected.
+	constexpr float MaxDistanceCompensation = 1000.0f;
+
+	struct SpatialiserCore;
+
+	// A sound source created ahead of time. A spatialiser effect claims one on creation and uses it as its effect
+	// data, so spawning neither creates a source nor edits the BRT graph. Every slot is connected to every listener
+	// from creation, and idle slots are parked, playing silence. Slots live in
+	// the core's source arena, each starting on its own cache line so mixer threads running different
+	// spatialisers never touch the same line.
+	struct alignas (CacheLineSize) SourceSlot
+	{
+		std::string sourceID;  // Only used to talk to BRT and in logs
+		size_t index = 0;      // In SpatialiserCore::sourceSlots
+		UInt32 generation = 0; // Bumped on every claim
+		std::shared_ptr<BRTSourceModel::CSourceSimpleModel> soundSource;
+		CMonoBuffer<float> inMonoBuffer;
+		std::array<float, NumSourceParameters> parameters {};
+		// Equal to SpatialiserCore::sceneUpdate while the latest scene snapshot positions this source
+		UInt32 sceneUpdate = 0;
+		// Level of the mono input, read through the spatialiser's GetFloatBufferCallback
+		Meter meter;
+		// Distance to listener 0 in metres when the source was last positioned
+		float listenerDistance = 0.0f;
+		// Position last set on the BRT source, unset while it is parked
+		std::optional<Common::CVector3> pushedPosition;
+		// pushedPosition relative to listener 0's pose on BRT as of listenerPoseUpdate
+		Common::CVector3 pushedLocalPosition;
+		// SpatialiserCore::listenerPoseUpdate when pushedLocalPosition was last worked out
+		UInt32 listenerPoseUpdate = 0;
+		// Reductions the QualityController's level currently applies to this source
+		bool isReverbCulled = false;  // Disconnected from every BRIR model
+		bool isEconomy = false;
+		// What the distance attenuation callback needs, kept by the audio thread as Unity calls the callback from
+		// another thread. On a line of their own, away from the state only the audio thread touches.
+		alignas (CacheLineSize) std::atomic<float> distanceScale { 1.0f };  // SpatialiserCore::scaleFactor
+		std::atomic<float> attenuationPerDoubling { 0.0f };  // Anechoic distance attenuation of listener 0 in dB
+		// The distance law gain last reported to Unity, which Unity has applied to the input
+		std::atomic<float> reportedDistanceGain { 1.0f };
+		// The core whose pool this slot belongs to. Cleared if the core is destroyed while the slot is claimed,
+		// the effect then deletes the slot itself.
+		SpatialiserCore* owner = nullptr;
+		bool isClaimed = false;
+		// The arena the slot was created in, kept alive by its slots so one can outlive the core
+		std::shared_ptr<SlabArena> arena;
+
+		Handle handle() const { return MakeHandle (index, generation); }
+	};
+
+	// Destroys a slot created in a source arena. The arena is freed with the last of its slots.
+	struct SourceSlotDeleter
+	{
+		void operator() (SourceSlot* slot) const;
+	};
+	using SourceSlotPtr = std::unique_ptr<SourceSlot, SourceSlotDeleter>;
+
 	//==========================================================================
 	struct SpatialiserCore
 	{
@@ -88,12 +253,47 @@ namespace BRTSpatialiserCore
         std::shared_ptr<BRTBase::CListener> listener;                           // Pointer to listener model
         std::shared_ptr<BRTListenerModel::CListenerHRTFModel> listenerHRTFModel;
         std::shared_ptr<BRTListenerModel::CListenerAmbisonicEnvironmentBRIRModel> listenerBRIRModel;
+        // Every listener, indexed by the index part of its handle. listeners[0] holds listener and its models
+        // above, removed listeners leave a null entry so indices stay stable.
+        std::vector<std::unique_ptr<ListenerSlot>> listeners;
+        static constexpr size_t MaxListeners = 8;
+        // Generation of the last listener at each index, kept while the entry is empty
+        std::array<UInt32, MaxListeners> listenerGenerations {};
+        // Blocks each additional listener can queue before the oldest is dropped
+        static constexpr size_t ListenerOutputBlocks = 4;
+        // The resource last installed for each role on listener 0, given to listeners added later
+        std::array<LoadedBinary, NumBinaryRoles> installedBinaries;
         
 		std::array<float, NumSourceParameters> perSourceInitialValues;
 		float scaleFactor;
 		bool isLimiterEnabled;
 		bool enableReverbProcessing;
-        UInt32 numSoundSources = 0;
+		// Grid step in degrees used for HRTF and BRIR tables, the format raw HRIRs are kept in and the settings
+		// BRT keeps on the HRTF table. Changing any of them rebuilds the affected tables in the background.
+		TableSettings tableSettings;
+		// The most recently requested path for each role, used to rebuild tables when the resampling step changes
+		std::array<std::string, NumBinaryRoles> requestedPaths;
+		std::array<size_t, NumBinaryRoles> tableBytes {};
+        // Every source slot created so far, and those not claimed by an effect. The pool only grows.
+        std::vector<SourceSlotPtr> sourceSlots;
+        std::vector<SourceSlot*> freeSourceSlots;
+        // Contiguous, cache line aligned storage for the slots
+        std::shared_ptr<SlabArena> sourceArena;
+        PerformanceMonitor performance;
+        QualityController quality;
+        // Counts the scene snapshots applied, starting from 1
+        UInt32 sceneUpdate = 0;
+        PoseTolerance poseTolerance;
+        // Seconds from rendering a block until it is heard, the time head poses are extrapolated ahead by
+        float headPoseOutputLatency = 0.02f;
+        size_t sourcePoolSize = 16;
+        // Slots the source arena adds at a time once the reserved pool is exhausted
+        static constexpr size_t SourceSlabSize = 16;
+        // Largest pool created ahead of time. SourcePoolSize creates and connects them all under the mutex, so this
+        // stays well below what handles can address.
+        static constexpr size_t MaxSourcePoolSize = 256;
+        // Most sources that can exist at once, as many as a handle can index
+        static constexpr size_t MaxSources = 1u << HandleIndexBits;
         
 		// This mutex must be locked during any use of the spatializer instance, or in the creation/destruction of instances.
 		inline static std::mutex& mutex()
@@ -113,8 +313,84 @@ namespace BRTSpatialiserCore
 
 		bool loadBinary (BinaryRole role, std::string path);
 
+		// Parses a binary resource without touching any core state. This is the slow part of loading and is safe
+		// to call without SpatialiserCore::mutex, e.g. from the ResourceLoader threads. If progress is provided it
+		// is updated between 0 and 1 as the read advances.
+		static LoadedBinary readBinary (BinaryRole role, std::string path, const TableSettings& settings, std::atomic<float>* progress = nullptr);
+		// One line saying what a read produced and how much memory its table takes, for the log
+		static std::string describeBinary (const LoadedBinary& binary);
+		// Sets a previously read resource on the listener and swaps it with the one it replaces, so the caller
+		// decides which thread frees the replaced tables. Doesn't log, so it is safe on the audio thread.
+		// Mutex must be locked.
+		bool installBinary (LoadedBinary& binary);
+		// Installs any resources the ResourceLoader has finished since the last call. Mutex must be locked.
+		// Called at the start of every block by the manager so loads complete without blocking the audio thread.
+		void applyPendingBinaries();
+
+		// Creates slots until the pool holds at least numSlots. Must not be called inside a manager setup.
+		void reserveSourceSlots (size_t numSlots);
+		// Takes a free source slot. The BRT graph is only edited if the pool is exhausted and a slot has to be
+		// created. Must not be called inside a manager setup. Mutex must be locked.
+		SourceSlot* claimSourceSlot();
+		// Parks a slot and returns it to the pool, still connected, invalidating its handle. Mutex must be locked.
+		void releaseSourceSlot (SourceSlot* slot);
+		// The claimed slot a handle refers to, or nullptr if the handle is stale. Mutex must be locked.
+		SourceSlot* getSourceSlot (Handle handle);
+		// Sets listener 0 from the latest HeadPoseSlot pose, extrapolated to when the block about to be rendered
+		// will be heard, while poses keep arriving. Called at the start of every block by the manager. Mutex must be locked.
+		void applyHeadPose();
+		// True while listener 0 follows head poses instead of Unity's listener matrix
+		bool isListenerPosedByHead() const { return isFollowingHeadPose; }
+		// Positions every source in the latest SceneSnapshot, if one was published since the last call. Called at
+		// the start of every block by the manager. Mutex must be locked.
+		void applySceneSnapshot();
+		// True if the source should take its position from Unity's matrix rather than the scene snapshot
+		bool isPositionedByUnity (const SourceSlot& slot) const { return slot.sceneUpdate == 0 || slot.sceneUpdate != sceneUpdate; }
+		// False on the blocks an economy source keeps its previous position
+		bool shouldRepositionSource (const SourceSlot& slot) const;
+		// True the first time in a block a spatialiser passes listener 0's matrix, and whenever it or the scale
+		// factor changes: every spatialiser is given the same matrix, so it only needs converting once.
+		bool hasListenerMatrixChanged (const float* listenerMatrix);
+		// Sets listener 0's pose on BRT if it moved beyond poseTolerance from the pose BRT has
+		void moveMainListener (const Common::CTransform& transform);
+		// Sets a source's position on BRT if it moved beyond poseTolerance in listener 0's frame. Sources that
+		// stay put in the world aren't repositioned at all, and sources that move with the listener are only
+		// carried along with it, without changing the direction BRT hears them from. Keeps the source's
+		// listenerDistance up to date either way. Mutex must be locked.
+		void moveSource (SourceSlot& slot, const Common::CVector3& position);
+
+		// Feeds the block just closed by the performance monitor to the quality controller and applies its level.
+		// Called by the manager after every block. Mutex must be locked.
+		void updateQuality();
+		// The controller's state with the source counts filled in. Mutex must be locked.
+		QualityState getQualityState() const;
+
+		// Adds a listener that hears every source and returns its handle, or InvalidHandle if there are too many.
+		Handle addListener();
+		bool removeListener (Handle handle);
+		// The listener a handle refers to, or nullptr if it has been removed
+		ListenerSlot* getListener (Handle handle);
+		Handle getMainListenerHandle() const { return listeners[0]->handle; }
+		// Sets a previously read resource on one listener only and swaps it with the one it replaces, like
+		// installBinary. Mutex must be locked.
+		bool installListenerBinary (ListenerSlot& slot, LoadedBinary& binary);
+		// Makes a listener follow listener 0 again for role. Its own binary is moved into replaced, so the caller
+		// can free it once the mutex is released. Mutex must be locked.
+		bool resetListenerBinary (Handle handle, BinaryRole role, LoadedBinary& replaced);
+		// Called by the manager after processing to queue the output of every listener but the first
+		void renderListenerOutputs();
+		// Reads a block queued by renderListenerOutputs for an additional listener, or writes silence if none is
+		// ready or the handle is stale
+		bool readListenerOutput (Handle handle, float* interleaved, size_t numFrames);
+
 		bool SetFloat (int parameter, float value);
 		bool GetFloat (int parameter, float* value);
+		// Sets several parameters as one update: tables affected by more than one of them are only rebuilt once.
+		// Each value is replaced with the one actually applied, or NaN for an unknown parameter. Returns the number of
+		// parameters that were accepted.
+		int SetFloats (ParameterValue* values, int count);
+		// Fills values with parameters 0 to count - 1, NaN where a parameter can't be read. Returns the number read.
+		int GetFloats (float* values, int count);
 
 		class IncorrectAudioStateException : public std::runtime_error
 		{
@@ -139,6 +415,34 @@ namespace BRTSpatialiserCore
 		static bool resetInstanceIfNecessary(UInt32 sampleRate, UInt32 bufferSize);
 
 	private:
+		std::unique_ptr<ListenerSlot> createListenerSlot (size_t index);
+		// Creates an idle source, connected to every listener. Manager must be in setup.
+		SourceSlot* createSourceSlot();
+		// Connect or disconnect a source and a listener's models. Manager must be in setup.
+		bool connectSoundSource (const SourceSlot& source, const ListenerSlot& listener);
+		void disconnectSoundSource (const SourceSlot& source, const ListenerSlot& listener);
+		bool installOnListener (ListenerSlot& slot, const LoadedBinary& binary);
+		// Reassesses which sources the current quality level applies to and makes the BRT calls for any change
+		void applyQualityLevel();
+		// Turns a listener's interpolation and near field filters off, or back to what they were, to follow
+		// isHRTFReducedByQuality
+		void applyQualityToListener (ListenerSlot& slot);
+		// True while QualityNoInterpolation or lower has interpolation and near field filters turned off
+		bool isHRTFReducedByQuality = false;
+		// Listener 0's matrix and scale factor as last passed by a spatialiser, and the pose last set on BRT
+		std::array<float, 16> listenerMatrix {};
+		float listenerMatrixScale = 0.0f;
+		Common::CTransform mainListenerPose;
+		// Bumped whenever mainListenerPose is set on BRT
+		UInt32 listenerPoseUpdate = 0;
+		bool isFollowingHeadPose = false;
+		// Scratch for ranking the claimed sources by distance, reserved with the pool
+		std::vector<SourceSlot*> qualityRanking;
+		// Queues background reads of the current files for roles, picking up the current tableSettings. Inside
+		// SetFloats the roles are only noted, and read once the whole batch is applied.
+		void reloadTables (std::initializer_list<BinaryRole> roles);
+		bool isApplyingBatch = false;
+		std::array<bool, NumBinaryRoles> batchReloads {};
 		static SpatialiserCore*& instancePtr();
 	};
 
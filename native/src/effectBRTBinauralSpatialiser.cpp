@@ -29,12 +29,11 @@ namespace BRTBinauralSpatialiser
 {
 	using namespace BRTSpatialiserCore;
 
-	struct EffectData
-	{
-		std::string sourceID;    // DEBUG
-        std::shared_ptr<BRTSourceModel::CSourceSimpleModel> soundSource;
-        CMonoBuffer<float> inMonoBuffer;
-	};
+	// Each effect instance uses a slot claimed from the core's source pool as its data
+	using EffectData = SourceSlot;
+
+	// Read only, after the per-source parameters. Lets C# find the source's Handle with GetSpatializerFloat.
+	const int SourceHandleParameter = FloatParameter::NumSourceParameters;
 
 	template <class T>
     void WriteLog (std::string logText, const T& value, std::string sourceID = "")
@@ -64,7 +63,7 @@ void WriteLog (std::string logtext)
 
 int InternalRegisterEffectDefinition(UnityAudioEffectDefinition& definition)
 {
-	int numparams = FloatParameter::NumSourceParameters;
+	int numparams = SourceHandleParameter + 1;
 	definition.paramdefs = new UnityAudioParameterDefinition[numparams];
 	//RegisterParameter(definition, "SourceID", "", -1.0f, /*FLT_MAX*/ 1e20f, -1.0f, 1.0f, 1.0f, PARAM_SOURCE_ID, "Source ID for debug");
 	RegisterParameter(definition, "HRTFInterp", "", 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, FloatParameter::EnableHRTFInterpolation, "HRTF Interpolation method");
@@ -74,6 +73,7 @@ int InternalRegisterEffectDefinition(UnityAudioEffectDefinition& definition)
 	RegisterParameter(definition, "SpatMode", "", 0.0f, 2.0f, 0.0f, 1.0f, 1.0f, FloatParameter::SpatializationMode, "Spatialization mode (0=High quality, 1=High performance, 2=None)");
 	RegisterParameter(definition, "EnableReverb", "", 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, FloatParameter::EnableReverbSend, "Enable reverb processing");
 	RegisterParameter(definition, "RevDistAtt", "", 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, FloatParameter::EnableDistanceAttenuationReverb, "Enable distance attenuation for reverb processing");
+	RegisterParameter(definition, "SourceHandle", "", 0.0f, (float) (1 << 24), 0.0f, 1.0f, 1.0f, SourceHandleParameter, "Handle of this source in the plugin (read only)");
 	//Sample Rate and BufferSize
 	definition.flags |= UnityAudioEffectDefinitionFlags_IsSpatializer;
 	return numparams;
@@ -155,9 +155,23 @@ Common::CTransform ComputeSourceTransformFromMatrix(float* sourceMatrix, float s
 }
 
 //==============================================================================
+// Unity uses the attenuation returned here to decide which voices to virtualise, so it is Unity's own rolloff
+// times the gain of BRT's distance law. Unity calls this outside the audio thread, so it only reads the state the
+// source cached on its last block. Unity also applies the attenuation to the input, and the process callback
+// takes the distance law back off, so only the broadband law goes in here.
 static UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK DistanceAttenuationCallback(UnityAudioEffectState* state, float distanceIn, float attenuationIn, float* attenuationOut)
 {
-	*attenuationOut = attenuationIn;
+	EffectData* data = state->GetEffectData<EffectData>();
+	if (data == nullptr)
+	{
+		*attenuationOut = attenuationIn;
+		return UNITY_AUDIODSP_OK;
+	}
+
+	const float distanceGain = DistanceLawGain (distanceIn * data->distanceScale.load (std::memory_order_relaxed),
+	                                            data->attenuationPerDoubling.load (std::memory_order_relaxed));
+	data->reportedDistanceGain.store (distanceGain, std::memory_order_relaxed);
+	*attenuationOut = attenuationIn * distanceGain;
 	return UNITY_AUDIODSP_OK;
 }
 
@@ -167,10 +181,17 @@ UNITY_AUDIODSP_RESULT SetFloatParameter (SpatialiserCore* spatializer, UnityAudi
     EffectData* data = state->GetEffectData<EffectData>();
     assert (data != nullptr && spatializer != nullptr);
 
+    if (index >= FloatParameter::FirstSourceParameter && index < FloatParameter::NumSourceParameters)
+        data->parameters[index] = value;
+
     // Process command sent by C# API
     switch (index)
     {
 
+    case SourceHandleParameter:
+        // Read only
+        return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+
     case FloatParameter::EnableHRTFInterpolation:
         if (value != 0.0f)
         {
@@ -285,28 +306,12 @@ UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK CreateCallback (UnityAudioEffectSt
 
 	// CREATE Instance state and grab parameters
 
-	EffectData* effectdata = new EffectData;
-    effectdata->inMonoBuffer.resize (state->dspbuffersize);
-    
-    // Create sound source
-    effectdata->sourceID = "SoundSource_" + std::to_string (spatializer->numSoundSources);
-    WriteLog ("BRT: Creating sound source: " + effectdata->sourceID);
-    
+    // The source is already created and connected to every listener, unless the pool has run dry
+	EffectData* effectdata = spatializer->claimSourceSlot();
+    if (effectdata == nullptr)
     {
-        const BRTHelpers::ScopedManagerSetup sm (spatializer->brtManager);
-        
-        effectdata->soundSource = spatializer->brtManager.CreateSoundSource<BRTSourceModel::CSourceSimpleModel> (effectdata->sourceID);
-        
-        if (effectdata->soundSource == nullptr)
-            WriteLog ("BRT: Error creating sound source: " + effectdata->sourceID);
-        else
-            spatializer->numSoundSources++;
-
-        if (! spatializer->listenerHRTFModel->ConnectSoundSource (effectdata->sourceID))
-            WriteLog ("BRT: Error connecting sound source to HRTF model");
-
-        if (! spatializer->listenerBRIRModel->ConnectSoundSource (effectdata->sourceID))
-            WriteLog ("BRT: Error connecting sound source to BRIR model");
+        WriteLog ("BRT: Error creating sound source");
+        return UNITY_AUDIODSP_ERR_UNSUPPORTED;
     }
     
     state->effectdata = effectdata;
@@ -338,30 +343,11 @@ UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK ReleaseCallback (UnityAudioEffectS
     {
         std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
         
-        SpatialiserCore* spatializer;
-        try
-        {
-            spatializer = SpatialiserCore::instance (state->samplerate, state->dspbuffersize);
-        }
-        catch (const SpatialiserCore::IncorrectAudioStateException& e)
-        {
-            WriteLog (std::string ("Error: Spatialiser ReleaseCallback called with incorrect audio state. ") + e.what());
-        }
-        
-        spatializer->brtManager.BeginSetup();
-        
-        if (! spatializer->listenerHRTFModel->DisconnectSoundSource (data->sourceID))
-            WriteLog ("BRT: Error disconnecting sound source from HRTF model");
-
-        if (! spatializer->listenerBRIRModel->DisconnectSoundSource (data->sourceID))
-            WriteLog ("BRT: Error disconnecting sound source from BRIR model");
-        
-        if (! spatializer->brtManager.RemoveSoundSource (data->sourceID))
-            WriteLog ("BRT: Error removing sound source: " + data->sourceID);
-
-        spatializer->brtManager.EndSetup();
-        
-        delete data;
+        // The slot goes back to the pool still connected. It only has no owner if the core was reset since.
+        if (data->owner != nullptr)
+            data->owner->releaseSourceSlot (data);
+        else
+            SourceSlotDeleter() (data);
     }
 	return UNITY_AUDIODSP_OK;
 }
@@ -414,6 +400,9 @@ UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK GetFloatParameterCallback (UnityAu
 
 	if (value != NULL)
 	{
+		if (data != nullptr && index >= FloatParameter::FirstSourceParameter && index < FloatParameter::NumSourceParameters)
+			*value = data->parameters[index];
+
 		switch (index)
 		{
 		case FloatParameter::EnableHRTFInterpolation:
@@ -437,6 +426,9 @@ UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK GetFloatParameterCallback (UnityAu
 		case FloatParameter::EnableDistanceAttenuationReverb:
 //			*value = (float)source->IsDistanceAttenuationEnabledReverb();
 			break;
+		case SourceHandleParameter:
+			*value = data != nullptr ? (float) data->handle() : (float) InvalidHandle;
+			break;
 		default:
 			return UNITY_AUDIODSP_ERR_UNSUPPORTED;
 		}
@@ -446,7 +438,12 @@ UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK GetFloatParameterCallback (UnityAu
 
 int UNITY_AUDIODSP_CALLBACK GetFloatBufferCallback(UnityAudioEffectState* state, const char* name, float* buffer, int numsamples)
 {
-	return UNITY_AUDIODSP_OK;
+	// No lock, the meter is published lock free by the audio thread
+	EffectData* data = state->GetEffectData<EffectData>();
+	if (data == nullptr || name == nullptr || buffer == nullptr || numsamples <= 0)
+		return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+
+	return ReadMeter (data->meter, name, buffer, numsamples) ? UNITY_AUDIODSP_OK : UNITY_AUDIODSP_ERR_UNSUPPORTED;
 }
 
 UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK
@@ -482,20 +479,32 @@ ProcessCallback (UnityAudioEffectState* state, float* inbuffer, float* outbuffer
 	}
 
 	EffectData* data = state->GetEffectData<EffectData>();
+    const ScopedStageTimer timer (spatializer->performance, StageSourceInput);
 
-	  // Set source and listener transform
-    data->soundSource->SetSourceTransform (ComputeSourceTransformFromMatrix (state->spatializerdata->sourcematrix, spatializer->scaleFactor));
-    spatializer->listener->SetListenerTransform (ComputeListenerTransformFromMatrix(state->spatializerdata->listenermatrix, spatializer->scaleFactor));
+	  // Set source and listener transform. Either is only passed on to BRT once it has moved far enough to matter.
+    // While head poses arrive the manager has already set the listener from them.
+    if (! spatializer->isListenerPosedByHead() && spatializer->hasListenerMatrixChanged (state->spatializerdata->listenermatrix))
+        spatializer->moveMainListener (ComputeListenerTransformFromMatrix (state->spatializerdata->listenermatrix, spatializer->scaleFactor));
 
-	// Transform input buffer
-	size_t j = 0;
-	for (size_t i = 0; i < length; i++)
-	{
-		data->inMonoBuffer[i] = (inbuffer[j] + inbuffer[j + 1]) / 2.0f;	// We take average of left and right channels
-		j += 2;
-	}
+    // Sources in the scene snapshot were already positioned by the manager
+    if (spatializer->isPositionedByUnity (*data) && spatializer->shouldRepositionSource (*data))
+    {
+        const Common::CTransform sourceTransform = ComputeSourceTransformFromMatrix (state->spatializerdata->sourcematrix, spatializer->scaleFactor);
+        spatializer->moveSource (*data, sourceTransform.GetPosition());
+    }
+
+	// For the distance attenuation callback
+	data->distanceScale.store (spatializer->scaleFactor, std::memory_order_relaxed);
+	data->attenuationPerDoubling.store (spatializer->listener->GetDistanceAttenuationFactor(), std::memory_order_relaxed);
+
+	// Transform input buffer. The input carries the distance law the callback reported as well as Unity's rolloff,
+	// and BRT applies that law itself, so exactly the gain Unity was given is taken back off, up to a limit.
+	const float reportedGain = data->reportedDistanceGain.load (std::memory_order_relaxed);
+	const float compensation = 1.0f / std::max (reportedGain, 1.0f / MaxDistanceCompensation);
+	BRTHelpers::DownmixStereo (inbuffer, data->inMonoBuffer.data(), length, compensation);	// We take average of left and right channels
 
     data->soundSource->SetBuffer (data->inMonoBuffer);
+    data->meter.process (data->inMonoBuffer.data(), 1, (int) length);
 
     for (size_t i = 0; i < (size_t) length * std::max (inchannels, outchannels); ++i)
     {
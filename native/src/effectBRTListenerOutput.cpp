@@ -0,0 +1,121 @@
+/**
+ * BRT-Unity: Listener Output
+**/
+
+#include "SpatialiserCore.h"
+
+//==============================================================================
+// Plays the binaural output of one of the additional listeners added with BRTSpatialiserAddListener. The BRT
+// Manager renders every listener in the same pass, so this effect only copies out what it queued.
+namespace BRTListenerOutput
+{
+    using namespace BRTSpatialiserCore;
+
+	enum Parameter
+	{
+		Listener = 0,
+		NumParameters = 1
+	};
+
+	struct EffectData
+	{
+		std::array<float, NumParameters> parameters;
+	};
+
+    inline void WriteLog (std::string logText)
+    {
+        std::cerr << logText << std::endl;
+    }
+
+    //==========================================================================
+	UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK CreateCallback (UnityAudioEffectState* state)
+	{
+        auto effectdata = new EffectData;
+        effectdata->parameters = {
+            (float) InvalidHandle, // listener
+        };
+        state->effectdata = effectdata;
+
+		return UNITY_AUDIODSP_OK;
+	}
+
+    UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK ReleaseCallback (UnityAudioEffectState* state)
+    {
+        if (EffectData* data = state->GetEffectData<EffectData>())
+            delete data;
+
+        return UNITY_AUDIODSP_OK;
+    }
+
+	int InternalRegisterEffectDefinition (UnityAudioEffectDefinition& definition)
+	{
+		definition.paramdefs = new UnityAudioParameterDefinition[NumParameters];
+		// The whole handle is passed, so an effect left pointing at a removed listener never plays whoever reuses its slot
+		const Handle maxHandle = MakeHandle (SpatialiserCore::MaxListeners - 1, MaxHandleGeneration);
+		RegisterParameter (definition, "Listener", "", 0.0f, (float) maxHandle, (float) InvalidHandle,
+                           1.0f, 1.0f, Listener, "Handle of the additional listener to play, as returned by BRTSpatialiserAddListener");
+		return NumParameters;
+	}
+
+	UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK
+    SetFloatParameterCallback (UnityAudioEffectState* state, int index, float value)
+	{
+		EffectData* data = state->GetEffectData<EffectData>();
+
+        if (index < 0 || index >= NumParameters || data == nullptr)
+		{
+			return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+		}
+
+        std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+		data->parameters[index] = value;
+
+        return UNITY_AUDIODSP_OK;
+	}
+
+	UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK
+    GetFloatParameterCallback (UnityAudioEffectState* state, int index, float* value, char *valuestr)
+	{
+		EffectData* data = state->GetEffectData<EffectData>();
+
+		if (index < 0 || index >= NumParameters || data == nullptr)
+		{
+			return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+		}
+
+        std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+		*value = data->parameters[index];
+
+        return UNITY_AUDIODSP_OK;
+	}
+
+	int UNITY_AUDIODSP_CALLBACK
+    GetFloatBufferCallback (UnityAudioEffectState* state, const char* name, float* buffer, int numsamples)
+	{
+		return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+	}
+
+	UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK
+    ProcessCallback (UnityAudioEffectState* state, float* inbuffer, float* outbuffer,
+                     unsigned int length, int inchannels, int outchannels)
+	{
+		if (inchannels != 2 || outchannels != 2)
+		{
+            WriteLog ("BRT: ERROR: Incorrect channel count in Listener Output plugin");
+			return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+		}
+
+        std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+        EffectData* data = state->GetEffectData<EffectData>();
+        SpatialiserCore* spatializer = SpatialiserCore::instance();
+
+        // Silence until the listener exists and the manager has rendered a block for it, and once it is removed
+        if (spatializer == nullptr)
+            std::fill (outbuffer, outbuffer + 2 * length, 0.0f);
+        else
+            spatializer->readListenerOutput ((Handle) std::lround (data->parameters[Listener]), outbuffer, length);
+
+		return UNITY_AUDIODSP_OK;
+	}
+}
@@ -21,6 +21,7 @@ namespace BRTManager
 		std::array<float, NumParameters> parameters;
         CMonoBuffer<float> outLeftBuffer;
         CMonoBuffer<float> outRightBuffer;
+        Meter meter;  // Level of the master output
 	};
 
     std::atomic<bool> doesInstanceExist { false };
@@ -30,6 +31,27 @@ namespace BRTManager
         std::cerr << logText << std::endl;
     }
 
+    // Copies a struct of 4 byte fields to buffer as floats. The fields from firstCountOffset on are UInt32 counts
+    // and are converted, the ones before are already floats.
+    template <class Fields>
+    void WriteFieldsAsFloats (const Fields& fields, size_t firstCountOffset, float* buffer, int numsamples)
+    {
+        static_assert (sizeof (Fields) % sizeof (float) == 0, "Fields must be made of 4 byte fields");
+        const size_t numFields = sizeof (Fields) / sizeof (float);
+
+        float values[numFields];
+        std::memcpy (values, &fields, sizeof (fields));
+        for (size_t i = firstCountOffset / sizeof (float); i < numFields; ++i)
+        {
+            UInt32 count;
+            std::memcpy (&count, &values[i], sizeof (count));
+            values[i] = (float) count;
+        }
+
+        std::fill (buffer, buffer + numsamples, 0.0f);
+        std::copy (values, values + std::min ((size_t) numsamples, numFields), buffer);
+    }
+
     //==========================================================================
 	UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK CreateCallback (UnityAudioEffectState* state)
 	{
@@ -106,6 +128,44 @@ namespace BRTManager
 	int UNITY_AUDIODSP_CALLBACK
     GetFloatBufferCallback (UnityAudioEffectState* state, const char* name, float* buffer, int numsamples)
 	{
+        // Meters are published lock free, so they are read without waiting for the audio thread
+        EffectData* data = state->GetEffectData<EffectData>();
+        if (data != nullptr && name != nullptr && buffer != nullptr && numsamples > 0)
+        {
+            if (ReadMeter (data->meter, name, buffer, numsamples))
+                return UNITY_AUDIODSP_OK;
+        }
+
+        std::lock_guard<std::mutex> lock (SpatialiserCore::mutex());
+
+        SpatialiserCore* spatializer = SpatialiserCore::instance();
+        if (spatializer == nullptr || name == nullptr || buffer == nullptr || numsamples <= 0)
+            return UNITY_AUDIODSP_ERR_UNSUPPORTED;
+
+        // The EngineStats fields in order, as floats
+        if (std::strcmp (name, "Stats") == 0)
+        {
+            const size_t idleSources = spatializer->freeSourceSlots.size();
+            const EngineStats stats = spatializer->performance.getStats ((UInt32) (spatializer->sourceSlots.size() - idleSources), (UInt32) idleSources);
+            WriteFieldsAsFloats (stats, offsetof (EngineStats, activeSources), buffer, numsamples);
+            return UNITY_AUDIODSP_OK;
+        }
+
+        // The QualityState fields in order, as floats
+        if (std::strcmp (name, "Quality") == 0)
+        {
+            WriteFieldsAsFloats (spatializer->getQualityState(), offsetof (QualityState, level), buffer, numsamples);
+            return UNITY_AUDIODSP_OK;
+        }
+
+        // The most recent block times in milliseconds, oldest first
+        if (std::strcmp (name, "BlockTimes") == 0)
+        {
+            const size_t count = spatializer->performance.getBlockTimes (buffer, (size_t) numsamples);
+            std::fill (buffer + count, buffer + numsamples, 0.0f);
+            return UNITY_AUDIODSP_OK;
+        }
+
 		return UNITY_AUDIODSP_ERR_UNSUPPORTED;
 	}
 
@@ -138,15 +198,35 @@ namespace BRTManager
         auto& outLeftBuffer = data->outLeftBuffer;
         auto& outRightBuffer = data->outRightBuffer;
         
-        spatializer->brtManager.ProcessAll();
-        spatializer->listener->GetBuffers (outLeftBuffer, outRightBuffer);
-    
-        for (size_t i = 0; i < length; ++i)
         {
-            outbuffer[i * 2 + 0] = outLeftBuffer[i];
-            outbuffer[i * 2 + 1] = outRightBuffer[i];
+            const ScopedStageTimer timer (spatializer->performance, StageResources);
+
+            // Install anything the ResourceLoader finished since the last block
+            spatializer->applyPendingBinaries();
+            spatializer->applyHeadPose();
+            spatializer->applySceneSnapshot();
         }
 
+        {
+            const ScopedStageTimer timer (spatializer->performance, StageRender);
+            spatializer->brtManager.ProcessAll();
+        }
+
+        {
+            const ScopedStageTimer timer (spatializer->performance, StageOutput);
+            spatializer->listener->GetBuffers (outLeftBuffer, outRightBuffer);
+
+            // Queue the output of any additional listeners for their BRT Listener Output effects
+            spatializer->renderListenerOutputs();
+        
+            BRTHelpers::InterleaveStereo (outLeftBuffer.data(), outRightBuffer.data(), outbuffer, length);
+
+            data->meter.process (outbuffer, 2, (int) length);
+        }
+
+        spatializer->performance.endBlock();
+        spatializer->updateQuality();
+
 		return UNITY_AUDIODSP_OK;
 	}
 }
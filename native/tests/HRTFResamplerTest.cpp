@@ -0,0 +1,184 @@
+// Checks the plugin's parallel HRTF resampling against BRT's own reader on a real SOFA file, and measures how
+// long each takes to load it. For each resampling step:
+//
+//   grid    Every direction of MakeResamplingGrid must be one BRT keeps as is. BRT's table is read back at each
+//           direction without run time interpolation and its delays must be exactly the ones the plugin added.
+//           If BRT's grid had a direction the plugin's lacks, BRT would interpolate its neighbours there instead.
+//   hrir    The HRIRs BRT's reader resamples and the plugin's must agree to within the tolerances below. The two
+//           interpolate differently (inverse distance weighting against BRT's barycentric weights), so they are
+//           close rather than equal.
+//   load    Milliseconds for BRT's reader and for HRIRMeasurementSet::load plus BuildResampledHRTF.
+//
+// Exits with 1 if any check fails.
+//
+// Usage: HRTFResamplerTest file.sofa [--steps 15,5] [--buffer 512]
+
+#include "HRTFResampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace BRTSpatialiserCore;
+
+namespace
+{
+    // Error of the plugin's HRIRs relative to BRT's, in dB of the energy of BRT's
+    const double MaxMeanErrorDb = -20.0;
+    const double MaxErrorDb = -10.0;
+    // Samples the interpolated delays may differ by
+    const float MaxDelayDifference = 2.0f;
+
+    std::vector<int> ParseList (const char* text)
+    {
+        std::vector<int> values;
+        std::stringstream list (text);
+        for (std::string item; std::getline (list, item, ',');)
+            values.push_back (std::atoi (item.c_str()));
+        return values;
+    }
+
+    template <typename Body>
+    double MeasureMs (Body&& body)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Energy of the difference between two partitioned HRIRs and of the reference, summed over the partitions
+    void AddError (const std::vector<CMonoBuffer<float>>& test, const std::vector<CMonoBuffer<float>>& reference,
+                   double& errorEnergy, double& referenceEnergy)
+    {
+        for (size_t p = 0; p < std::min (test.size(), reference.size()); ++p)
+        {
+            for (size_t i = 0; i < std::min (test[p].size(), reference[p].size()); ++i)
+            {
+                const double difference = (double) test[p][i] - reference[p][i];
+                errorEnergy += difference * difference;
+                referenceEnergy += (double) reference[p][i] * reference[p][i];
+            }
+        }
+    }
+
+    bool TestStep (const std::string& path, int step)
+    {
+        std::printf ("Resampling step %d degrees\n", step);
+        bool hasPassed = true;
+
+        auto reference = std::make_shared<BRTServices::CHRTF>();
+        BRTReaders::CSOFAReader sofaReader;
+        bool isReferenceLoaded = false;
+        const double referenceMs = MeasureMs ([&]
+        {
+            isReferenceLoaded = sofaReader.ReadHRTFFromSofa (path, reference, step, BRTServices::TEXTRAPOLATION_METHOD::nearest_point);
+        });
+
+        auto resampled = std::make_shared<BRTServices::CHRTF>();
+        std::unique_ptr<HRIRMeasurementSet> measurements;
+        bool isResampledLoaded = false;
+        const double resampledMs = MeasureMs ([&]
+        {
+            measurements = HRIRMeasurementSet::load (path);
+            isResampledLoaded = measurements != nullptr && BuildResampledHRTF (*measurements, step, resampled);
+        });
+
+        if (! isReferenceLoaded || ! isResampledLoaded)
+        {
+            std::printf ("  FAIL: could not load %s (BRT %s, plugin %s)\n", path.c_str(), isReferenceLoaded ? "ok" : "failed",
+                         isResampledLoaded ? "ok" : "failed");
+            return false;
+        }
+        std::printf ("  load: BRT %.1f ms, plugin %.1f ms, %.2fx\n", referenceMs, resampledMs, referenceMs / resampledMs);
+
+        const std::vector<GridDirection> grid = MakeResamplingGrid (step);
+        const int irLength = measurements->getIRLength();
+        std::vector<float> left ((size_t) irLength), right ((size_t) irLength), scratch ((size_t) 2 * irLength);
+        const Common::CTransform listener;
+
+        int numMissing = 0;
+        double errorDbSum = 0.0;
+        double maxErrorDb = -300.0;
+        float maxDelayDifference = 0.0f;
+        for (const GridDirection& direction : grid)
+        {
+            // BRT takes elevations below the horizon as 270..360
+            const float azimuth = direction.azimuth;
+            const float elevation = direction.elevation < 0.0f ? direction.elevation + 360.0f : direction.elevation;
+
+            float leftDelay, rightDelay;
+            measurements->interpolate (direction.azimuth, direction.elevation, left.data(), right.data(), leftDelay, rightDelay, scratch.data());
+            const float addedDelays[2] = { (float) std::max (0L, std::lround (leftDelay)), (float) std::max (0L, std::lround (rightDelay)) };
+
+            double errorEnergy = 0.0, referenceEnergy = 0.0;
+            for (Common::T_ear ear : { Common::T_ear::LEFT, Common::T_ear::RIGHT })
+            {
+                const float delay = resampled->GetHRIRDelay (ear, azimuth, elevation, false, listener);
+                if (delay != addedDelays[ear])
+                    ++numMissing;
+
+                maxDelayDifference = std::max (maxDelayDifference, std::fabs (delay - reference->GetHRIRDelay (ear, azimuth, elevation, false, listener)));
+                AddError (resampled->GetHRIR_partitioned (ear, azimuth, elevation, false, listener),
+                          reference->GetHRIR_partitioned (ear, azimuth, elevation, false, listener), errorEnergy, referenceEnergy);
+            }
+
+            const double errorDb = 10.0 * std::log10 (std::max (errorEnergy, 1e-30) / std::max (referenceEnergy, 1e-30));
+            errorDbSum += errorDb;
+            maxErrorDb = std::max (maxErrorDb, errorDb);
+        }
+
+        const double meanErrorDb = errorDbSum / (double) grid.size();
+        std::printf ("  grid: %zu directions, %d ear delays not kept as added\n", grid.size(), numMissing);
+        std::printf ("  hrir: mean error %.1f dB, worst %.1f dB, largest delay difference %.1f samples\n", meanErrorDb, maxErrorDb,
+                     maxDelayDifference);
+
+        if (numMissing > 0)
+        {
+            std::printf ("  FAIL: BRT's grid has directions the plugin's doesn't\n");
+            hasPassed = false;
+        }
+        if (meanErrorDb > MaxMeanErrorDb || maxErrorDb > MaxErrorDb || maxDelayDifference > MaxDelayDifference)
+        {
+            std::printf ("  FAIL: HRIRs differ from BRT's resampler beyond tolerance\n");
+            hasPassed = false;
+        }
+        return hasPassed;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf (stderr, "Usage: HRTFResamplerTest file.sofa [--steps 15,5] [--buffer 512]\n");
+        return 2;
+    }
+
+    const std::string path = argv[1];
+    std::vector<int> steps { 15, 5 };
+    int bufferSize = 512;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--steps")        steps = ParseList (argv[i + 1]);
+        else if (arg == "--buffer")  bufferSize = std::atoi (argv[i + 1]);
+    }
+
+    // The tables are partitioned for the global buffer size, and the file's sample rate has to match
+    BRTReaders::CSOFAReader sofaReader;
+    Common::CGlobalParameters globalParameters;
+    globalParameters.SetSampleRate (sofaReader.GetSampleRateFromSofa (path));
+    globalParameters.SetBufferSize (bufferSize);
+
+    bool hasPassed = true;
+    for (int step : steps)
+        hasPassed = TestStep (path, step) && hasPassed;
+
+    std::printf (hasPassed ? "PASS\n" : "FAIL\n");
+    return hasPassed ? 0 : 1;
+}
@@ -0,0 +1,542 @@
+// Loads the built plugin the way Unity does and replays Unity's threading pattern against it, to measure lock
+// contention and spawn spikes without a device or the editor:
+//
+//   Mixer       Every block, the spatialiser ProcessCallback of every live source runs in parallel on a pool of
+//               worker threads, then the BRT Manager's ProcessCallback runs on the mixer thread. Blocks are
+//               started on the audio clock unless --freewheel is given.
+//   Main        Meanwhile the main thread creates and releases sources, sets global and per-source parameters
+//               and reloads the HRTF, as scripts and the audio engine would.
+//
+// At the end the latency of every kind of call is reported as percentiles and a histogram, along with the
+// xruns: blocks that were not finished by the time the next one was due.
+//
+// Usage: BRTHostSimulator AudioPluginBRTUnity.so [--hrtf file.sofa] [--brir file.sofa] [--samplerate 48000]
+//                         [--buffer 512] [--sources 64] [--workers 4] [--seconds 10] [--churn 20]
+//                         [--param-rate 200] [--reload 2] [--freewheel]
+//
+//   --churn       Sources released and created again per second
+//   --param-rate  Parameter changes per second, alternating between global and per-source
+//   --reload      Seconds between HRTF reloads through BRTSpatialiserLoadBinary, 0 to never reload
+
+#include "AudioPluginInterface.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dlfcn.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Must match FloatParameter and BinaryRole in SpatialiserCore.h. The simulator only talks to the plugin
+    // through its exports so it doesn't need the BRT headers.
+    constexpr int EnableFarDistanceLPF = 1;
+    constexpr int ScaleFactor = 8;
+    constexpr int AnechoicDistanceAttenuation = 10;
+    constexpr int SourcePoolSize = 24;
+    constexpr int HighQualityHRTF = 1;
+    constexpr int ReverbBRIR = 3;
+
+    using GetDefinitionsFunction = int (*) (UnityAudioEffectDefinition***);
+    using ResetIfNeededFunction = bool (*) (int, int);
+    using LoadBinaryFunction = bool (*) (int, const char*, int, int);
+    using SetFloatFunction = bool (*) (int, float);
+
+    struct Plugin
+    {
+        void* library = nullptr;
+        UnityAudioEffectDefinition* manager = nullptr;
+        UnityAudioEffectDefinition* spatialiser = nullptr;
+        ResetIfNeededFunction resetIfNeeded = nullptr;
+        LoadBinaryFunction loadBinary = nullptr;
+        SetFloatFunction setFloat = nullptr;
+
+        bool load (const char* path)
+        {
+            library = dlopen (path, RTLD_NOW | RTLD_LOCAL);
+            if (library == nullptr)
+            {
+                std::fprintf (stderr, "%s\n", dlerror());
+                return false;
+            }
+
+            auto getDefinitions = (GetDefinitionsFunction) dlsym (library, "UnityGetAudioEffectDefinitions");
+            resetIfNeeded = (ResetIfNeededFunction) dlsym (library, "BRTSpatialiserResetIfNeeded");
+            loadBinary = (LoadBinaryFunction) dlsym (library, "BRTSpatialiserLoadBinary");
+            setFloat = (SetFloatFunction) dlsym (library, "BRTSpatialiserSetFloat");
+            if (getDefinitions == nullptr || resetIfNeeded == nullptr || loadBinary == nullptr || setFloat == nullptr)
+            {
+                std::fprintf (stderr, "%s is missing some of the BRT exports\n", path);
+                return false;
+            }
+
+            UnityAudioEffectDefinition** definitions = nullptr;
+            const int numEffects = getDefinitions (&definitions);
+            for (int i = 0; i < numEffects; ++i)
+            {
+                if (std::strcmp (definitions[i]->name, "BRT Manager") == 0)
+                    manager = definitions[i];
+                else if (std::strcmp (definitions[i]->name, "BRT Binaural Spatialiser") == 0)
+                    spatialiser = definitions[i];
+            }
+            if (manager == nullptr || spatialiser == nullptr)
+            {
+                std::fprintf (stderr, "%s does not define the BRT effects\n", path);
+                return false;
+            }
+            return true;
+        }
+    };
+
+    struct Options
+    {
+        const char* pluginPath = nullptr;
+        const char* hrtf = nullptr;
+        const char* brir = nullptr;
+        int sampleRate = 48000;
+        int bufferSize = 512;
+        int numSources = 64;
+        int numWorkers = 4;
+        double seconds = 10.0;
+        double churn = 20.0;
+        double parameterRate = 200.0;
+        double reloadInterval = 2.0;
+        bool isFreewheeling = false;
+    };
+
+    //==========================================================================
+    enum CallKind
+    {
+        SourceProcess,
+        ManagerProcess,
+        Block,
+        Create,
+        Release,
+        SetGlobalFloat,
+        SetSourceFloat,
+        LoadBinary,
+        NumCallKinds
+    };
+
+    const char* const CallKindNames[NumCallKinds] = {
+        "source process", "manager process", "whole block", "create", "release", "set global float",
+        "set source float", "load binary"
+    };
+
+    // Durations recorded by one thread, merged after the run so recording never synchronises
+    struct Recorder
+    {
+        std::vector<double> micros[NumCallKinds];
+
+        template <typename Call>
+        void time (CallKind kind, Call&& call)
+        {
+            const auto start = Clock::now();
+            call();
+            micros[kind].push_back (std::chrono::duration<double, std::micro> (Clock::now() - start).count());
+        }
+    };
+
+    void PrintReport (std::vector<double> (&micros)[NumCallKinds])
+    {
+        for (int k = 0; k < NumCallKinds; ++k)
+        {
+            std::vector<double>& samples = micros[k];
+            if (samples.empty())
+                continue;
+
+            std::sort (samples.begin(), samples.end());
+            const auto percentile = [&] (double p) { return samples[std::min (samples.size() - 1, (size_t) (p * samples.size()))]; };
+            double sum = 0.0;
+            for (double s : samples)
+                sum += s;
+
+            std::printf ("%-17s %8zu calls  mean %9.1f  p50 %9.1f  p99 %9.1f  p99.9 %9.1f  max %9.1f us\n", CallKindNames[k],
+                         samples.size(), sum / samples.size(), percentile (0.5), percentile (0.99), percentile (0.999), samples.back());
+
+            // Power of two buckets, from under 1 us
+            std::vector<size_t> buckets;
+            for (double s : samples)
+            {
+                const size_t b = s < 1.0 ? 0 : (size_t) std::log2 (s) + 1;
+                if (buckets.size() <= b)
+                    buckets.resize (b + 1);
+                ++buckets[b];
+            }
+            for (size_t b = 0; b < buckets.size(); ++b)
+            {
+                if (buckets[b] == 0)
+                    continue;
+                const int width = (int) std::lround (50.0 * buckets[b] / samples.size());
+                std::printf ("    < %8.0f us %8zu %.*s\n", std::ldexp (1.0, (int) b), buckets[b], std::max (width, 1),
+                             "##################################################");
+            }
+        }
+    }
+
+    //==========================================================================
+    // One effect instance, with the state Unity would hand to its callbacks
+    struct Effect
+    {
+        UnityAudioEffectDefinition* definition = nullptr;
+        UnityAudioEffectState state {};
+        UnityAudioSpatializerData spatializerData {};
+
+        bool create (UnityAudioEffectDefinition* d, const Options& options)
+        {
+            definition = d;
+            state = {};
+            spatializerData = {};
+            state.structsize = sizeof (UnityAudioEffectState);
+            state.samplerate = (UInt32) options.sampleRate;
+            state.dspbuffersize = (UInt32) options.bufferSize;
+            state.hostapiversion = UNITY_AUDIO_PLUGIN_API_VERSION;
+            state.flags = UnityAudioEffectStateFlags_IsPlaying;
+            state.internal = this;
+            state.spatializerdata = &spatializerData;
+            return definition->create (&state) == UNITY_AUDIODSP_OK;
+        }
+    };
+
+    // A source the main thread creates and releases while the mixer plays it. The mixer only processes Live
+    // sources and is the one to move a Releasing source to Retired, so the main thread never releases an effect
+    // a worker is still processing.
+    struct Source
+    {
+        enum State { Empty, Live, Releasing, Retired };
+
+        Effect effect;
+        std::atomic<int> state { Empty };
+        float angle = 0.0f;
+    };
+
+    // Lets the mixer thread run a block of sources on the workers and wait for them
+    class WorkerPool
+    {
+    public:
+        explicit WorkerPool (int numThreads)
+        {
+            for (int i = 0; i < numThreads; ++i)
+            {
+                threads.emplace_back ([this, i]
+                {
+                    UInt64 seen = 0;
+                    for (;;)
+                    {
+                        {
+                            std::unique_lock<std::mutex> lock (mutex);
+                            started.wait (lock, [&] { return generation != seen || isStopping; });
+                            if (isStopping)
+                                return;
+                            seen = generation;
+                        }
+                        work (i + 1);
+
+                        std::lock_guard<std::mutex> lock (mutex);
+                        if (--numBusy == 0)
+                            finished.notify_one();
+                    }
+                });
+            }
+        }
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                isStopping = true;
+            }
+            started.notify_all();
+            for (auto& t : threads)
+                t.join();
+        }
+
+        // Runs w on every worker and on the calling thread, as worker 0, and returns once all of them are done
+        void run (std::function<void (int)> w)
+        {
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                work = std::move (w);
+                numBusy = (int) threads.size();
+                ++generation;
+            }
+            started.notify_all();
+            work (0);
+
+            std::unique_lock<std::mutex> lock (mutex);
+            finished.wait (lock, [&] { return numBusy == 0; });
+        }
+
+    private:
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable started, finished;
+        std::function<void (int)> work;
+        UInt64 generation = 0;
+        int numBusy = 0;
+        bool isStopping = false;
+    };
+
+    void PlaceSource (Source& source)
+    {
+        float* l = source.effect.spatializerData.listenermatrix;
+        float* s = source.effect.spatializerData.sourcematrix;
+        std::fill (l, l + 16, 0.0f);
+        std::fill (s, s + 16, 0.0f);
+        l[0] = l[5] = l[10] = l[15] = 1.0f;
+        s[0] = s[5] = s[10] = s[15] = 1.0f;
+        s[12] = 3.0f * std::sin (source.angle);
+        s[14] = 3.0f * std::cos (source.angle);
+    }
+
+    //==========================================================================
+    int Run (const Options& options, Plugin& plugin)
+    {
+        plugin.resetIfNeeded (options.sampleRate, options.bufferSize);
+        if (options.hrtf != nullptr && ! plugin.loadBinary (HighQualityHRTF, options.hrtf, options.sampleRate, options.bufferSize))
+            std::fprintf (stderr, "Failed to load %s\n", options.hrtf);
+        if (options.brir != nullptr && ! plugin.loadBinary (ReverbBRIR, options.brir, options.sampleRate, options.bufferSize))
+            std::fprintf (stderr, "Failed to load %s\n", options.brir);
+        plugin.setFloat (SourcePoolSize, (float) options.numSources);
+
+        Effect manager;
+        if (! manager.create (plugin.manager, options))
+        {
+            std::fprintf (stderr, "Failed to create the BRT Manager\n");
+            return 1;
+        }
+
+        std::vector<std::unique_ptr<Source>> sources;
+        for (int i = 0; i < options.numSources; ++i)
+        {
+            sources.push_back (std::make_unique<Source>());
+            sources.back()->angle = 6.2831853f * (float) i / (float) options.numSources;
+            if (sources.back()->effect.create (plugin.spatialiser, options))
+                sources.back()->state = Source::Live;
+        }
+
+        const size_t frames = (size_t) options.bufferSize;
+        const size_t numBlocks = (size_t) std::ceil (options.seconds * options.sampleRate / options.bufferSize);
+        const auto period = std::chrono::duration<double> ((double) options.bufferSize / options.sampleRate);
+
+        std::vector<Recorder> workerRecorders ((size_t) options.numWorkers + 1);
+        Recorder mixerRecorder, mainRecorder;
+        std::vector<std::vector<float>> workerBuffers ((size_t) options.numWorkers + 1, std::vector<float> (frames * 4));
+        std::vector<float> managerIn (frames * 2, 0.0f), managerOut (frames * 2);
+
+        std::atomic<bool> isRunning { true };
+        std::atomic<size_t> nextSource { 0 };
+        size_t numXruns = 0;
+        double worstLateness = 0.0;
+
+        // The main thread's part, on its own thread so this one can be the mixer
+        std::thread mainThread ([&]
+        {
+            std::mt19937 random (7);
+            std::uniform_int_distribution<size_t> pickSource (0, sources.size() - 1);
+            const auto start = Clock::now();
+            double nextChurn = 0.0, nextParameter = 0.0, nextReload = options.reloadInterval;
+            bool isGlobal = true;
+
+            while (isRunning)
+            {
+                const double now = std::chrono::duration<double> (Clock::now() - start).count();
+
+                // Releasing needs the mixer to retire the source first, so each churn is spread over two steps
+                for (auto& source : sources)
+                {
+                    if (source->state == Source::Retired)
+                    {
+                        mainRecorder.time (Release, [&] { source->effect.definition->release (&source->effect.state); });
+                        source->state = Source::Empty;
+                    }
+                    if (source->state == Source::Empty)
+                    {
+                        bool isCreated = false;
+                        mainRecorder.time (Create, [&] { isCreated = source->effect.create (plugin.spatialiser, options); });
+                        source->state = isCreated ? Source::Live : Source::Empty;
+                    }
+                }
+
+                if (options.churn > 0.0 && now >= nextChurn)
+                {
+                    int expected = Source::Live;
+                    sources[pickSource (random)]->state.compare_exchange_strong (expected, Source::Releasing);
+                    nextChurn += 1.0 / options.churn;
+                }
+
+                if (options.parameterRate > 0.0 && now >= nextParameter)
+                {
+                    if (isGlobal)
+                    {
+                        const int parameter = random() % 2 == 0 ? ScaleFactor : AnechoicDistanceAttenuation;
+                        const float value = parameter == ScaleFactor ? 1.0f : (random() % 2 == 0 ? -6.0f : -3.0f);
+                        mainRecorder.time (SetGlobalFloat, [&] { plugin.setFloat (parameter, value); });
+                    }
+                    else
+                    {
+                        Source& source = *sources[pickSource (random)];
+                        if (source.state == Source::Live)
+                            mainRecorder.time (SetSourceFloat, [&]
+                            {
+                                plugin.spatialiser->setfloatparameter (&source.effect.state, EnableFarDistanceLPF, (float) (random() % 2));
+                            });
+                    }
+                    isGlobal = ! isGlobal;
+                    nextParameter += 1.0 / options.parameterRate;
+                }
+
+                if (options.hrtf != nullptr && options.reloadInterval > 0.0 && now >= nextReload)
+                {
+                    mainRecorder.time (LoadBinary, [&] { plugin.loadBinary (HighQualityHRTF, options.hrtf, options.sampleRate, options.bufferSize); });
+                    nextReload += options.reloadInterval;
+                }
+
+                std::this_thread::sleep_for (std::chrono::microseconds (500));
+            }
+        });
+
+        {
+            std::vector<float> input (frames * 2);
+            std::mt19937 random (3);
+            std::uniform_real_distribution<float> noise (-0.25f, 0.25f);
+            for (auto& s : input)
+                s = noise (random);
+
+            WorkerPool workers (options.numWorkers);
+
+            const auto start = Clock::now();
+            for (size_t b = 0; b < numBlocks; ++b)
+            {
+                const auto due = start + std::chrono::duration_cast<Clock::duration> (period * (double) b);
+                if (! options.isFreewheeling)
+                    std::this_thread::sleep_until (due);
+                const auto blockStart = options.isFreewheeling ? Clock::now() : due;
+
+                mixerRecorder.time (Block, [&]
+                {
+                    // Retire sources the main thread asked to release, as no worker is running now
+                    for (auto& source : sources)
+                    {
+                        int expected = Source::Releasing;
+                        source->state.compare_exchange_strong (expected, Source::Retired);
+                    }
+
+                    nextSource = 0;
+                    workers.run ([&] (int w)
+                    {
+                        float* out = workerBuffers[(size_t) w].data();
+                        for (size_t i; (i = nextSource++) < sources.size();)
+                        {
+                            Source& source = *sources[i];
+                            if (source.state != Source::Live)
+                                continue;
+                            source.angle += 0.005f;
+                            PlaceSource (source);
+                            workerRecorders[(size_t) w].time (SourceProcess, [&]
+                            {
+                                source.effect.definition->process (&source.effect.state, input.data(), out, (unsigned int) frames, 2, 2);
+                            });
+                        }
+                    });
+
+                    mixerRecorder.time (ManagerProcess, [&]
+                    {
+                        manager.definition->process (&manager.state, managerIn.data(), managerOut.data(), (unsigned int) frames, 2, 2);
+                    });
+                });
+
+                // The block was due at blockStart and had to be done before the next one was
+                const double lateness = std::chrono::duration<double> (Clock::now() - blockStart - period).count();
+                if (lateness > 0.0)
+                {
+                    ++numXruns;
+                    worstLateness = std::max (worstLateness, lateness);
+                }
+            }
+        }
+
+        isRunning = false;
+        mainThread.join();
+
+        for (auto& source : sources)
+            if (source->state != Source::Empty)
+                source->effect.definition->release (&source->effect.state);
+        manager.definition->release (&manager.state);
+
+        std::vector<double> merged[NumCallKinds];
+        std::vector<const Recorder*> recorders { &mixerRecorder, &mainRecorder };
+        for (const auto& r : workerRecorders)
+            recorders.push_back (&r);
+        for (const Recorder* r : recorders)
+            for (int k = 0; k < NumCallKinds; ++k)
+                merged[k].insert (merged[k].end(), r->micros[k].begin(), r->micros[k].end());
+
+        std::printf ("%d sources on %d workers plus the mixer, %d frames at %d Hz (%.0f us per block), %s\n\n",
+                     options.numSources, options.numWorkers, options.bufferSize, options.sampleRate, 1e6 * period.count(),
+                     options.isFreewheeling ? "freewheeling" : "real time");
+        PrintReport (merged);
+        std::printf ("\n%zu xruns in %zu blocks, worst %.1f us late\n", numXruns, numBlocks, 1e6 * worstLateness);
+        return numXruns == 0 ? 0 : 3;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        const bool hasValue = value != nullptr && arg != "--freewheel";
+
+        if (arg == "--freewheel")                    options.isFreewheeling = true;
+        else if (arg[0] != '-')                      options.pluginPath = argv[i];
+        else if (! hasValue)
+        {
+            std::fprintf (stderr, "Missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        else if (arg == "--hrtf")                    options.hrtf = value;
+        else if (arg == "--brir")                    options.brir = value;
+        else if (arg == "--samplerate")              options.sampleRate = std::atoi (value);
+        else if (arg == "--buffer")                  options.bufferSize = std::atoi (value);
+        else if (arg == "--sources")                 options.numSources = std::max (1, std::atoi (value));
+        else if (arg == "--workers")                 options.numWorkers = std::max (0, std::atoi (value));
+        else if (arg == "--seconds")                 options.seconds = std::atof (value);
+        else if (arg == "--churn")                   options.churn = std::atof (value);
+        else if (arg == "--param-rate")              options.parameterRate = std::atof (value);
+        else if (arg == "--reload")                  options.reloadInterval = std::atof (value);
+        else
+        {
+            std::fprintf (stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+
+        if (hasValue && arg[0] == '-')
+            ++i;
+    }
+
+    if (options.pluginPath == nullptr)
+    {
+        std::fprintf (stderr, "Usage: %s AudioPluginBRTUnity.so [options]\n", argv[0]);
+        return 2;
+    }
+
+    Plugin plugin;
+    if (! plugin.load (options.pluginPath))
+        return 1;
+    return Run (options, plugin);
+}
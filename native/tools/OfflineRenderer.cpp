@@ -0,0 +1,619 @@
+// Renders scenes to binaural WAV files outside Unity, as fast as the machine allows. Each scene is played
+// through the plugin's own callbacks the way Unity's mixer drives them: every block, each source's
+// spatialiser effect is processed, then the BRT Manager, whose output is written to the file.
+//
+// The SpatialiserCore is a process-wide singleton, so scenes are rendered in parallel by forking one
+// process per scene, up to the number of jobs.
+//
+// Usage: BRTOfflineRenderer [-j jobs] scene.txt [scene.txt ...]
+//
+// A scene is a text file with one command per line. # starts a comment and paths are relative to the
+// scene file.
+//
+//   samplerate 48000               Sample rate of the render. Source files must match it. (48000)
+//   buffersize 512                 Frames per block (512)
+//   duration 10                    Seconds to render (until the longest non-looping source ends)
+//   output render.wav              Binaural output (the scene file with a .wav extension)
+//   resource HighQualityHRTF a.sofa  Loads a binary resource for one of the BinaryRoles
+//   set ScaleFactor 1              Sets any FloatParameter by name. Per-source parameters set before the
+//                                  first source become the defaults of every source.
+//   listener 0  0 0 0  0           Listener keyframe: time, x y z in Unity units, yaw in degrees
+//   source voice.wav [loop]        Adds a source. The key and set commands after it apply to this source.
+//   key 0  1 0 2                   Source keyframe: time, x y z
+//
+// Positions are interpolated linearly between keyframes and held before the first and after the last.
+
+#include "SpatialiserCore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace BRTSpatialiserCore;
+
+extern "C" bool BRTSpatialiserResetIfNeeded (int sampleRate, int dspBufferSize);
+extern "C" bool BRTSpatialiserLoadBinary (BinaryRole role, const char* path, int currentSampleRate, int dspBufferSize);
+extern "C" bool BRTSpatialiserSetFloat (int parameter, float value);
+
+namespace
+{
+    const std::pair<const char*, int> ParameterNames[] = {
+        { "EnableHRTFInterpolation", EnableHRTFInterpolation },
+        { "EnableFarDistanceLPF", EnableFarDistanceLPF },
+        { "EnableDistanceAttenuationAnechoic", EnableDistanceAttenuationAnechoic },
+        { "EnableNearFieldEffect", EnableNearFieldEffect },
+        { "SpatializationMode", SpatializationMode },
+        { "EnableReverbSend", EnableReverbSend },
+        { "EnableDistanceAttenuationReverb", EnableDistanceAttenuationReverb },
+        { "HeadRadius", HeadRadius },
+        { "ScaleFactor", ScaleFactor },
+        { "EnableCustomITD", EnableCustomITD },
+        { "AnechoicDistanceAttenuation", AnechoicDistanceAttenuation },
+        { "ILDAttenuation", ILDAttenuation },
+        { "SoundSpeed", SoundSpeed },
+        { "HearingAidDirectionalityAttenuationLeft", HearingAidDirectionalityAttenuationLeft },
+        { "HearingAidDirectionalityAttenuationRight", HearingAidDirectionalityAttenuationRight },
+        { "EnableHearingAidDirectionalityLeft", EnableHearingAidDirectionalityLeft },
+        { "EnableHearingAidDirectionalityRight", EnableHearingAidDirectionalityRight },
+        { "EnableLimiter", EnableLimiter },
+        { "HRTFResamplingStep", HRTFResamplingStep },
+        { "EnableReverbProcessing", EnableReverbProcessing },
+        { "ReverbOrder", ReverbOrder },
+        { "ReverbDistanceAttenuation", ReverbDistanceAttenuation },
+        { "HRIRStorageFormat", HRIRStorageFormat },
+        { "SourcePoolSize", SourcePoolSize },
+        { "EnableAdaptiveQuality", EnableAdaptiveQuality },
+        { "AdaptiveQualityMaxLevel", AdaptiveQualityMaxLevel },
+        { "AdaptiveQualityDegradeLoad", AdaptiveQualityDegradeLoad },
+        { "AdaptiveQualityRestoreLoad", AdaptiveQualityRestoreLoad },
+        { "AdaptiveQualityRestoreTime", AdaptiveQualityRestoreTime },
+        { "AdaptiveQualityReverbDistance", AdaptiveQualityReverbDistance },
+        { "AdaptiveQualityEconomyShare", AdaptiveQualityEconomyShare },
+        { "PoseAngleTolerance", PoseAngleTolerance },
+        { "PoseDistanceTolerance", PoseDistanceTolerance },
+        { "HeadPoseOutputLatency", HeadPoseOutputLatency },
+    };
+
+    const std::pair<const char*, BinaryRole> RoleNames[] = {
+        { "HighPerformanceILD", HighPerformanceILD },
+        { "HighQualityHRTF", HighQualityHRTF },
+        { "HighQualityILD", HighQualityILD },
+        { "ReverbBRIR", ReverbBRIR },
+    };
+
+    struct Keyframe
+    {
+        double time = 0.0;
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        float yaw = 0.0f;
+    };
+
+    Keyframe Interpolate (const std::vector<Keyframe>& keys, double time)
+    {
+        if (keys.empty())
+            return {};
+        if (time <= keys.front().time)
+            return keys.front();
+        if (time >= keys.back().time)
+            return keys.back();
+
+        const auto next = std::upper_bound (keys.begin(), keys.end(), time,
+                                            [] (double t, const Keyframe& k) { return t < k.time; });
+        const Keyframe& a = *(next - 1);
+        const Keyframe& b = *next;
+        const float f = (float) ((time - a.time) / (b.time - a.time));
+
+        Keyframe k;
+        k.time = time;
+        k.x = a.x + (b.x - a.x) * f;
+        k.y = a.y + (b.y - a.y) * f;
+        k.z = a.z + (b.z - a.z) * f;
+        k.yaw = a.yaw + (b.yaw - a.yaw) * f;
+        return k;
+    }
+
+    struct SourceDescription
+    {
+        std::string path;
+        bool isLooping = false;
+        std::vector<Keyframe> keys;
+        std::vector<std::pair<int, float>> parameters;
+        std::vector<float> samples;  // Interleaved stereo
+        size_t numFrames = 0;
+    };
+
+    struct Scene
+    {
+        std::string path;
+        std::string output;
+        int sampleRate = 48000;
+        int bufferSize = 512;
+        double duration = -1.0;
+        std::vector<std::pair<BinaryRole, std::string>> resources;
+        std::vector<std::pair<int, float>> parameters;
+        std::vector<Keyframe> listenerKeys;
+        std::vector<SourceDescription> sources;
+    };
+
+    //==========================================================================
+    UInt32 ReadLE (const unsigned char* bytes, int numBytes)
+    {
+        UInt32 value = 0;
+        for (int i = numBytes - 1; i >= 0; --i)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    // Reads PCM 16, 24 or 32 bit and 32 bit float WAV files, mono or stereo, into interleaved stereo
+    bool ReadWav (const std::string& path, int expectedSampleRate, std::vector<float>& samples, size_t& numFrames)
+    {
+        std::ifstream file (path, std::ios::binary);
+        std::vector<unsigned char> bytes ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char>());
+        if (bytes.size() < 12 || std::memcmp (bytes.data(), "RIFF", 4) != 0 || std::memcmp (bytes.data() + 8, "WAVE", 4) != 0)
+        {
+            std::fprintf (stderr, "%s: not a WAV file\n", path.c_str());
+            return false;
+        }
+
+        int format = 0, numChannels = 0, sampleRate = 0, bitsPerSample = 0;
+        const unsigned char* data = nullptr;
+        size_t dataSize = 0;
+        for (size_t pos = 12; pos + 8 <= bytes.size();)
+        {
+            const unsigned char* chunk = bytes.data() + pos;
+            const size_t size = std::min ((size_t) ReadLE (chunk + 4, 4), bytes.size() - pos - 8);
+            if (std::memcmp (chunk, "fmt ", 4) == 0 && size >= 16)
+            {
+                format = (int) ReadLE (chunk + 8, 2);
+                numChannels = (int) ReadLE (chunk + 10, 2);
+                sampleRate = (int) ReadLE (chunk + 12, 4);
+                bitsPerSample = (int) ReadLE (chunk + 22, 2);
+                if (format == 0xfffe && size >= 40)
+                    format = (int) ReadLE (chunk + 32, 2);  // WAVE_FORMAT_EXTENSIBLE sub format
+            }
+            else if (std::memcmp (chunk, "data", 4) == 0)
+            {
+                data = chunk + 8;
+                dataSize = size;
+            }
+            pos += 8 + size + (size & 1);
+        }
+
+        const bool isPCM = format == 1 && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+        const bool isFloat = format == 3 && bitsPerSample == 32;
+        if (data == nullptr || (! isPCM && ! isFloat) || numChannels < 1 || numChannels > 2)
+        {
+            std::fprintf (stderr, "%s: only mono or stereo PCM and float WAV files are supported\n", path.c_str());
+            return false;
+        }
+        if (sampleRate != expectedSampleRate)
+        {
+            std::fprintf (stderr, "%s: sample rate %d does not match the scene's %d\n", path.c_str(), sampleRate, expectedSampleRate);
+            return false;
+        }
+
+        const int bytesPerSample = bitsPerSample / 8;
+        numFrames = dataSize / ((size_t) bytesPerSample * numChannels);
+        samples.resize (numFrames * 2);
+        for (size_t f = 0; f < numFrames; ++f)
+        {
+            for (int c = 0; c < 2; ++c)
+            {
+                const unsigned char* s = data + (f * numChannels + std::min (c, numChannels - 1)) * bytesPerSample;
+                float value;
+                if (isFloat)
+                {
+                    const UInt32 bits = ReadLE (s, 4);
+                    std::memcpy (&value, &bits, sizeof (value));
+                }
+                else
+                {
+                    // Shift to the top of 32 bits so the sign extends
+                    const int32_t v = (int32_t) (ReadLE (s, bytesPerSample) << (32 - bitsPerSample));
+                    value = (float) v / 2147483648.0f;
+                }
+                samples[f * 2 + c] = value;
+            }
+        }
+        return true;
+    }
+
+    void WriteLE (std::ofstream& file, UInt32 value, int numBytes)
+    {
+        for (int i = 0; i < numBytes; ++i)
+            file.put ((char) ((value >> (8 * i)) & 0xff));
+    }
+
+    // Writes interleaved stereo as a 32 bit float WAV file
+    bool WriteWav (const std::string& path, const std::vector<float>& samples, int sampleRate)
+    {
+        std::ofstream file (path, std::ios::binary);
+        if (! file)
+        {
+            std::fprintf (stderr, "%s: cannot write\n", path.c_str());
+            return false;
+        }
+
+        const UInt32 dataSize = (UInt32) (samples.size() * sizeof (float));
+        file.write ("RIFF", 4);
+        WriteLE (file, 36 + dataSize, 4);
+        file.write ("WAVEfmt ", 8);
+        WriteLE (file, 16, 4);
+        WriteLE (file, 3, 2);  // IEEE float
+        WriteLE (file, 2, 2);
+        WriteLE (file, (UInt32) sampleRate, 4);
+        WriteLE (file, (UInt32) sampleRate * 2 * sizeof (float), 4);
+        WriteLE (file, 2 * sizeof (float), 2);
+        WriteLE (file, 32, 2);
+        file.write ("data", 4);
+        WriteLE (file, dataSize, 4);
+        for (float sample : samples)
+        {
+            UInt32 bits;
+            std::memcpy (&bits, &sample, sizeof (bits));
+            WriteLE (file, bits, 4);
+        }
+        return (bool) file;
+    }
+
+    //==========================================================================
+    std::string ResolvePath (const std::string& scenePath, const std::string& path)
+    {
+        if (path.empty() || path[0] == '/')
+            return path;
+        const size_t slash = scenePath.find_last_of ('/');
+        return slash == std::string::npos ? path : scenePath.substr (0, slash + 1) + path;
+    }
+
+    bool ParseScene (const std::string& path, Scene& scene)
+    {
+        std::ifstream file (path);
+        if (! file)
+        {
+            std::fprintf (stderr, "%s: cannot read\n", path.c_str());
+            return false;
+        }
+
+        scene.path = path;
+        const size_t dot = path.find_last_of ('.');
+        scene.output = (dot == std::string::npos || dot < path.find_last_of ('/') + 1 ? path : path.substr (0, dot)) + ".wav";
+
+        std::string line;
+        for (int lineNumber = 1; std::getline (file, line); ++lineNumber)
+        {
+            line = line.substr (0, line.find ('#'));
+            std::istringstream words (line);
+            std::string command;
+            if (! (words >> command))
+                continue;
+
+            bool isValid = true;
+            if (command == "samplerate")
+                isValid = (bool) (words >> scene.sampleRate) && scene.sampleRate > 0;
+            else if (command == "buffersize")
+                isValid = (bool) (words >> scene.bufferSize) && scene.bufferSize > 0;
+            else if (command == "duration")
+                isValid = (bool) (words >> scene.duration);
+            else if (command == "output")
+            {
+                std::string output;
+                isValid = (bool) (words >> output);
+                scene.output = ResolvePath (path, output);
+            }
+            else if (command == "resource")
+            {
+                std::string role, resource;
+                isValid = (bool) (words >> role >> resource);
+                const auto named = std::find_if (std::begin (RoleNames), std::end (RoleNames),
+                                                 [&] (const auto& r) { return role == r.first; });
+                isValid = isValid && named != std::end (RoleNames);
+                if (isValid)
+                    scene.resources.emplace_back (named->second, ResolvePath (path, resource));
+            }
+            else if (command == "set")
+            {
+                std::string name;
+                float value = 0.0f;
+                isValid = (bool) (words >> name >> value);
+                const auto named = std::find_if (std::begin (ParameterNames), std::end (ParameterNames),
+                                                 [&] (const auto& p) { return name == p.first; });
+                isValid = isValid && named != std::end (ParameterNames);
+                if (isValid)
+                {
+                    const bool isSourceParameter = named->second < NumSourceParameters;
+                    auto& parameters = isSourceParameter && ! scene.sources.empty() ? scene.sources.back().parameters : scene.parameters;
+                    parameters.emplace_back (named->second, value);
+                }
+            }
+            else if (command == "listener")
+            {
+                Keyframe k;
+                isValid = (bool) (words >> k.time >> k.x >> k.y >> k.z >> k.yaw);
+                scene.listenerKeys.push_back (k);
+            }
+            else if (command == "source")
+            {
+                SourceDescription source;
+                std::string option;
+                isValid = (bool) (words >> source.path);
+                source.path = ResolvePath (path, source.path);
+                source.isLooping = (words >> option) && option == "loop";
+                scene.sources.push_back (std::move (source));
+            }
+            else if (command == "key")
+            {
+                Keyframe k;
+                isValid = (bool) (words >> k.time >> k.x >> k.y >> k.z) && ! scene.sources.empty();
+                if (isValid)
+                    scene.sources.back().keys.push_back (k);
+            }
+            else
+                isValid = false;
+
+            if (! isValid)
+            {
+                std::fprintf (stderr, "%s:%d: cannot parse '%s'\n", path.c_str(), lineNumber, line.c_str());
+                return false;
+            }
+        }
+
+        const auto byTime = [] (const Keyframe& a, const Keyframe& b) { return a.time < b.time; };
+        std::stable_sort (scene.listenerKeys.begin(), scene.listenerKeys.end(), byTime);
+        for (auto& source : scene.sources)
+            std::stable_sort (source.keys.begin(), source.keys.end(), byTime);
+        return true;
+    }
+
+    //==========================================================================
+    // Unity's listener matrix goes from world space to the listener's space
+    void ListenerMatrix (const Keyframe& k, float* m)
+    {
+        const float yaw = k.yaw * (float) M_PI / 180.0f;
+        const float c = std::cos (yaw), s = std::sin (yaw);
+
+        // Column major inverse of a rotation about y followed by a translation
+        const float r[3][3] = { { c, 0.0f, -s }, { 0.0f, 1.0f, 0.0f }, { s, 0.0f, c } };
+        const float p[3] = { k.x, k.y, k.z };
+        std::fill (m, m + 16, 0.0f);
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 3; ++col)
+                m[col * 4 + row] = r[row][col];
+            m[12 + row] = -(r[row][0] * p[0] + r[row][1] * p[1] + r[row][2] * p[2]);
+        }
+        m[15] = 1.0f;
+    }
+
+    void SourceMatrix (const Keyframe& k, float* m)
+    {
+        std::fill (m, m + 16, 0.0f);
+        m[0] = m[5] = m[10] = m[15] = 1.0f;
+        m[12] = k.x;
+        m[13] = k.y;
+        m[14] = k.z;
+    }
+
+    UnityAudioEffectDefinition* FindEffect (const char* name)
+    {
+        UnityAudioEffectDefinition** definitions = nullptr;
+        const int numEffects = UnityGetAudioEffectDefinitions (&definitions);
+        for (int i = 0; i < numEffects; ++i)
+            if (std::strcmp (definitions[i]->name, name) == 0)
+                return definitions[i];
+        return nullptr;
+    }
+
+    // One effect instance, with the state Unity would hand to its callbacks
+    struct Effect
+    {
+        UnityAudioEffectDefinition* definition = nullptr;
+        UnityAudioEffectState state {};
+        UnityAudioSpatializerData spatializerData {};
+
+        bool create (UnityAudioEffectDefinition* d, const Scene& scene)
+        {
+            definition = d;
+            state.structsize = sizeof (UnityAudioEffectState);
+            state.samplerate = (UInt32) scene.sampleRate;
+            state.dspbuffersize = (UInt32) scene.bufferSize;
+            state.hostapiversion = UNITY_AUDIO_PLUGIN_API_VERSION;
+            state.flags = UnityAudioEffectStateFlags_IsPlaying;
+            state.internal = this;
+            state.spatializerdata = &spatializerData;
+            return definition->create (&state) == UNITY_AUDIODSP_OK;
+        }
+    };
+
+    bool RenderScene (const std::string& path)
+    {
+        Scene scene;
+        if (! ParseScene (path, scene))
+            return false;
+
+        double duration = scene.duration;
+        for (auto& source : scene.sources)
+        {
+            if (! ReadWav (source.path, scene.sampleRate, source.samples, source.numFrames))
+                return false;
+            if (! source.isLooping && scene.duration < 0.0)
+                duration = std::max (duration, (double) source.numFrames / scene.sampleRate);
+        }
+        if (duration < 0.0)
+        {
+            std::fprintf (stderr, "%s: give a duration, every source loops\n", path.c_str());
+            return false;
+        }
+
+        // The same steps the C# Spatializer takes before any audio is processed
+        BRTSpatialiserResetIfNeeded (scene.sampleRate, scene.bufferSize);
+        for (const auto& resource : scene.resources)
+        {
+            if (! BRTSpatialiserLoadBinary (resource.first, resource.second.c_str(), scene.sampleRate, scene.bufferSize))
+            {
+                std::fprintf (stderr, "%s: failed to load %s\n", path.c_str(), resource.second.c_str());
+                return false;
+            }
+        }
+        // Offline blocks have no deadline, so quality only adapts if the scene asks for it
+        BRTSpatialiserSetFloat (EnableAdaptiveQuality, 0.0f);
+        for (const auto& parameter : scene.parameters)
+            BRTSpatialiserSetFloat (parameter.first, parameter.second);
+
+        UnityAudioEffectDefinition* managerDefinition = FindEffect ("BRT Manager");
+        UnityAudioEffectDefinition* spatialiserDefinition = FindEffect ("BRT Binaural Spatialiser");
+        assert (managerDefinition != nullptr && spatialiserDefinition != nullptr);
+
+        Effect manager;
+        std::vector<Effect> sources (scene.sources.size());
+        bool isCreated = manager.create (managerDefinition, scene);
+        for (size_t s = 0; s < sources.size() && isCreated; ++s)
+        {
+            isCreated = sources[s].create (spatialiserDefinition, scene);
+            for (const auto& parameter : scene.sources[s].parameters)
+                isCreated = isCreated && spatialiserDefinition->setfloatparameter (&sources[s].state, parameter.first, parameter.second) == UNITY_AUDIODSP_OK;
+        }
+        if (! isCreated)
+        {
+            std::fprintf (stderr, "%s: failed to create the plugin effects\n", path.c_str());
+            return false;
+        }
+
+        const size_t blockSize = (size_t) scene.bufferSize;
+        const size_t numFrames = (size_t) std::ceil (duration * scene.sampleRate);
+        const size_t numBlocks = (numFrames + blockSize - 1) / blockSize;
+        std::vector<float> output (numBlocks * blockSize * 2);
+        std::vector<float> input (blockSize * 2);
+        std::vector<float> scratch (blockSize * 2);
+        const std::vector<float> silence (blockSize * 2, 0.0f);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < numBlocks; ++b)
+        {
+            const size_t firstFrame = b * blockSize;
+            const double time = (double) firstFrame / scene.sampleRate;
+
+            const Keyframe listener = Interpolate (scene.listenerKeys, time);
+            for (size_t s = 0; s < sources.size(); ++s)
+            {
+                const SourceDescription& description = scene.sources[s];
+                Effect& source = sources[s];
+                const Keyframe position = Interpolate (description.keys, time);
+                ListenerMatrix (listener, source.spatializerData.listenermatrix);
+                SourceMatrix (position, source.spatializerData.sourcematrix);
+
+                // Unity applies the attenuation the spatialiser asks for to the source before processing it.
+                // The scene has no rolloff curve of its own, so Unity's attenuation is 1.
+                float attenuation = 1.0f;
+                if (source.spatializerData.distanceattenuationcallback != nullptr)
+                {
+                    const float distance = std::sqrt ((position.x - listener.x) * (position.x - listener.x)
+                                                      + (position.y - listener.y) * (position.y - listener.y)
+                                                      + (position.z - listener.z) * (position.z - listener.z));
+                    source.spatializerData.distanceattenuationcallback (&source.state, distance, 1.0f, &attenuation);
+                }
+
+                for (size_t i = 0; i < blockSize; ++i)
+                {
+                    size_t frame = firstFrame + i;
+                    if (description.isLooping && description.numFrames > 0)
+                        frame %= description.numFrames;
+                    const bool isPlaying = frame < description.numFrames;
+                    input[i * 2 + 0] = isPlaying ? description.samples[frame * 2 + 0] * attenuation : 0.0f;
+                    input[i * 2 + 1] = isPlaying ? description.samples[frame * 2 + 1] * attenuation : 0.0f;
+                }
+
+                source.state.currdsptick = firstFrame;
+                spatialiserDefinition->process (&source.state, input.data(), scratch.data(), (unsigned int) blockSize, 2, 2);
+            }
+
+            manager.state.currdsptick = firstFrame;
+            managerDefinition->process (&manager.state, const_cast<float*> (silence.data()), output.data() + firstFrame * 2,
+                                        (unsigned int) blockSize, 2, 2);
+        }
+        const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+
+        for (auto& source : sources)
+            spatialiserDefinition->release (&source.state);
+        managerDefinition->release (&manager.state);
+
+        output.resize (numFrames * 2);
+        if (! WriteWav (scene.output, output, scene.sampleRate))
+            return false;
+
+        std::printf ("%s: %zu sources, %.1f s rendered in %.2f s (%.1fx real time) to %s\n", path.c_str(), sources.size(),
+                     duration, seconds, duration / std::max (seconds, 1e-9), scene.output.c_str());
+        return true;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    int numJobs = (int) std::max (1u, std::thread::hardware_concurrency());
+    std::vector<std::string> scenes;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp (argv[i], "-j") == 0 && i + 1 < argc)
+            numJobs = std::max (1, std::atoi (argv[++i]));
+        else
+            scenes.push_back (argv[i]);
+    }
+    if (scenes.empty())
+    {
+        std::fprintf (stderr, "Usage: %s [-j jobs] scene.txt [scene.txt ...]\n", argv[0]);
+        return 2;
+    }
+
+    if (scenes.size() == 1)
+        return RenderScene (scenes[0]) ? 0 : 1;
+
+    // One process per scene, as each needs its own SpatialiserCore
+    const auto start = std::chrono::steady_clock::now();
+    int numRunning = 0, numFailed = 0;
+    const auto waitForOne = [&]
+    {
+        int status = 0;
+        if (wait (&status) > 0)
+        {
+            --numRunning;
+            if (! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+                ++numFailed;
+        }
+    };
+
+    for (const auto& scene : scenes)
+    {
+        if (numRunning == numJobs)
+            waitForOne();
+
+        std::fflush (stdout);
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            const bool isRendered = RenderScene (scene);
+            std::fflush (stdout);
+            _exit (isRendered ? 0 : 1);
+        }
+        if (pid < 0)
+        {
+            std::fprintf (stderr, "%s: cannot start a process\n", scene.c_str());
+            ++numFailed;
+            continue;
+        }
+        ++numRunning;
+    }
+    while (numRunning > 0)
+        waitForOne();
+
+    const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+    std::printf ("%zu scenes in %.2f s with %d jobs, %d failed\n", scenes.size(), seconds, numJobs, numFailed);
+    return numFailed == 0 ? 0 : 1;
+}